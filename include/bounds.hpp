@@ -0,0 +1,58 @@
+/**
+ * @author      : Riccardo Brugo (brugo.riccardo@gmail.com)
+ * @file        : bounds
+ * @created     : Saturday Oct 17, 2026 19:02:18 CEST
+ * @license     : MIT
+ * */
+
+#ifndef BOUNDS_HPP
+#define BOUNDS_HPP
+
+#include <array>
+#include <limits>
+#include <algorithm>
+
+#include "common.hpp"
+
+namespace brun
+{
+
+// An axis aligned box [Gm]; a default constructed one is empty, and contains nothing
+struct bounding_box
+{
+    static constexpr auto inf = std::numeric_limits<double>::infinity();
+    std::array<double, 3> min = {inf, inf, inf};
+    std::array<double, 3> max = {-inf, -inf, -inf};
+
+    void expand(brun::position const & p) noexcept
+    {
+        for (auto k = 0ul; k < 3; ++k) {
+            min[k] = std::min(min[k], p[k].count());
+            max[k] = std::max(max[k], p[k].count());
+        }
+    }
+
+    void merge(bounding_box const & other) noexcept
+    {
+        for (auto k = 0ul; k < 3; ++k) {
+            min[k] = std::min(min[k], other.min[k]);
+            max[k] = std::max(max[k], other.max[k]);
+        }
+    }
+
+    // Whether the box, grown by `margin` on every side, touches the sphere of center `center` and radius `radius`
+    auto touches(brun::position const & center, double const radius, double const margin = 0.) const noexcept
+    {
+        auto distance2 = 0.;
+        for (auto k = 0ul; k < 3; ++k) {
+            auto const c = center[k].count();
+            auto const d = std::max({min[k] - margin - c, c - max[k] - margin, 0.});
+            distance2 += d * d;
+        }
+        return distance2 <= radius * radius;
+    }
+};
+
+} // namespace brun
+
+#endif /* BOUNDS_HPP */
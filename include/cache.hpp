@@ -0,0 +1,36 @@
+/**
+ * @author      : Riccardo Brugo (brugo.riccardo@gmail.com)
+ * @file        : cache
+ * @created     : Saturday Oct 17, 2026 10:31:18 CEST
+ * @license     : MIT
+ * */
+
+#ifndef CACHE_HPP
+#define CACHE_HPP
+
+#include <cstdint>
+#include <optional>
+#include <filesystem>
+#include <string_view>
+
+#include "scenario.hpp"
+
+namespace brun::cache
+{
+
+// Hash of the content of a scenario file, used as the key of its compiled image
+auto content_hash(std::string_view content) noexcept -> std::uint64_t;
+
+// Where the compiled image of a scenario file is stored (next to the source)
+auto path_for(std::filesystem::path const & source) -> std::filesystem::path;
+
+// Loads a compiled scenario, if it exists and it was built from a source with the given hash
+auto load(std::filesystem::path const & cache_path, std::uint64_t hash) -> std::optional<brun::scenario>;
+
+// Writes a flat binary image of a scenario; returns false if the image could not be written
+auto save(std::filesystem::path const & cache_path, std::uint64_t hash, brun::scenario const & data) -> bool;
+
+} // namespace brun::cache
+
+#endif /* CACHE_HPP */
+
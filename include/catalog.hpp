@@ -0,0 +1,46 @@
+/**
+ * @author      : Riccardo Brugo (brugo.riccardo@gmail.com)
+ * @file        : catalog
+ * @created     : Saturday Oct 17, 2026 12:05:16 CEST
+ * @license     : MIT
+ * */
+
+#ifndef CATALOG_HPP
+#define CATALOG_HPP
+
+#include <vector>
+#include <optional>
+#include <string_view>
+
+#include "scenario.hpp"
+#include "kepler.hpp"
+
+namespace brun
+{
+
+// Parses a line of a CSV catalog:
+//  name, mass [Yg], x, y, z [Gm], vx, vy, vz [km/s] (, color (, px_radius))
+// The color can be written as a decimal integer, as 0xRRGGBB or as #RRGGBB; missing or empty optional
+//  columns take their value from `defaults`. Returns nothing if the line is malformed
+auto parse_body_line(std::string_view line, brun::body_defaults const & defaults) -> std::optional<brun::body_record>;
+
+// Builds the reference to a catalog. The format can be "csv", "elements" or "binary"; if it is empty it is
+//  deduced from the extension of the file (".csv" for CSV catalogs, anything else for binary ones)
+auto make_catalog_ref(std::string_view path, std::string_view format, brun::body_defaults const & defaults)
+    -> brun::catalog_ref;
+
+// Reads every body of a catalog. The file is memory-mapped and parsed in parallel chunks; the bodies are
+//  returned in the same order in which they appear in the file
+// Binary catalogs start with the 8 characters "GRVBODY1" and a 64 bit count, followed by `count` records:
+//  char name[24] (NUL padded), double mass, double position[3], double velocity[3],
+//  uint32 color (0xAARRGGBB, AA == 0 => default color), float px_radius (< 0 => default radius)
+// Catalogs of elements are CSV files with the orbital elements of each body in place of its state:
+//  name, mass [Yg], a [Gm], e, i, Ω, ω, M [deg] (, color (, px_radius))
+//  all relative to the parent of the catalog, which is looked for with `find_parent`
+auto import_catalog(brun::catalog_ref const & catalog, brun::parent_lookup const & find_parent)
+    -> std::vector<brun::body_record>;
+
+} // namespace brun
+
+#endif /* CATALOG_HPP */
+
@@ -9,7 +9,6 @@
 #define COMMON_HPP
 
 #include <iostream>
-#include <deque>
 
 #include <fmt/format.h>
 #include <fmt/ostream.h>
@@ -25,6 +24,8 @@
 
 #include <range/v3/numeric/accumulate.hpp>
 
+#include "tag.hpp"
+
 namespace la = STD_LA;
 
 namespace brun
@@ -130,8 +131,6 @@ namespace brun
     using position  = la::fs_vector<position_scalar, 3>;       // 3-vec of Gm
     using velocity  = la::fs_vector<velocity_scalar, 3>;       // 3-vec of km/s
     using mass      = units::physical::si::mass<units::physical::si::yottagram>;    // Yg type
-    using trail     = std::deque<position>;                                         // list of past positions
-    using tag       = std::string;
     using px_radius = float;
     using rotation_matrix = la::fs_matrix<brun::position_scalar::rep, 3, 3>;
 
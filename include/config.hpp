@@ -8,13 +8,35 @@
 #ifndef INPUT_HPP
 #define INPUT_HPP
 
+#include <vector>
+#include <optional>
 #include <filesystem>
 #include <entt/entt.hpp>
 
+#include "scenario.hpp"
+#include "kepler.hpp"
+
 namespace brun
 {
 
-auto load_data(std::filesystem::path const & data) -> std::pair<entt::registry, float>;
+// Reads a scenario and hands its bodies to `sink`, in the order in which they are declared; the parents of
+//  the orbits are looked for with `find_parent`. Returns the trail density
+// The bodies of the included scenarios come first, in the order of the include list; a file included more
+//  than once gives its bodies only the first time. If `files` is not null, every file which has been read
+//  (the scenario and its includes) is appended to it
+auto load_scenario(
+    std::filesystem::path const & data, brun::body_sink const & sink, brun::parent_lookup const & find_parent,
+    std::vector<std::filesystem::path> * files = nullptr
+) -> float;
+
+// Ends the program when the scenario is not valid
+auto load_data(std::filesystem::path const & data, std::vector<std::filesystem::path> * files = nullptr)
+    -> std::pair<entt::registry, float>;
+
+// Reads all the bodies of a scenario, without creating any entity; the scenario is not read (and the
+//  reason is printed) when it is not valid
+auto read_bodies(std::filesystem::path const & data, std::vector<std::filesystem::path> * files = nullptr)
+    -> std::optional<std::vector<brun::body_record>>;
 
 } // namespace brun
 
@@ -8,8 +8,13 @@
 #ifndef CAMERA_HPP
 #define CAMERA_HPP
 
+#include <mutex>
+#include <chrono>
 #include <atomic>
+#include <cstdint>
+#include <vector>
 #include <variant>
+#include <functional>
 #include <shared_mutex>
 
 #include <entt/entt.hpp>
@@ -58,11 +63,31 @@ enum class status : int8_t
     stopped     // All threads have to stop
 };
 
+// When the simulation published its last state, how long after the previous one, and how much simulated
+//  time is between the two
+struct published_state
+{
+    std::chrono::steady_clock::time_point time;
+    std::chrono::steady_clock::duration interval = {};
+    double days = 0.;
+};
+
 struct context
 {
     std::atomic<brun::status> status = status::starting;
+    std::atomic<double> clock = 0.;             // simulated time [days]
+    std::atomic<std::uint64_t> revision = 0;    // changes every time bodies are added or removed
+    // For the culling of the renderer: the sum, step after step, of the farthest a body went in the step (no
+    //  body went farther since any step), and the highest speed of a body after the last step
+    std::atomic<double> travel = 0.;            // [Gm]
+    std::atomic<double> top_speed = 0.;         // [Gm/day]
+    // Epochs change with what they count, so that the renderer can tell when a frame would be the same as the
+    //  previous one
+    std::atomic<std::uint64_t> state_epoch = 0;     // the state of the bodies: every step, every edit
+    std::atomic<std::uint64_t> camera_epoch = 0;    // view radius, rotation and followed object
     brun::position_scalar view_radius;
     brun::rotation_info rotation;
+    brun::published_state published;            // guarded by the lock, like the registry
     entt::registry reg;
     follow_t follow;
 
@@ -76,6 +101,8 @@ struct context
 
 private:
     mutable std::shared_mutex ctx_mtx;
+    std::mutex edits_mtx;
+    std::vector<std::function<void(context &)>> edits;
 
 public:
     brun::position center_of_mass();
@@ -87,6 +114,35 @@ public:
     inline void lock_shared()     const noexcept { ctx_mtx.lock_shared(); }
     inline bool try_lock_shared() const noexcept { return ctx_mtx.try_lock_shared(); }
     inline void unlock_shared()   const noexcept { ctx_mtx.unlock_shared(); }
+
+    // To be called after every change of the camera
+    inline void camera_moved() noexcept { camera_epoch.fetch_add(1, std::memory_order::release); }
+
+    // Asks for a change of the registry from another thread: the simulation applies it between two steps
+    inline void defer(std::function<void(context &)> edit)
+    {
+        auto const _ = std::lock_guard{edits_mtx};
+        edits.push_back(std::move(edit));
+    }
+
+    // Applies the changes asked so far; to be called by the simulation thread, between two steps
+    inline void apply_edits()
+    {
+        auto pending = std::vector<std::function<void(context &)>>{};
+        {
+            auto const _ = std::lock_guard{edits_mtx};
+            pending.swap(edits);
+        }
+        if (pending.empty()) {
+            return;
+        }
+        auto const lock = std::scoped_lock{*this};
+        for (auto & edit : pending) {
+            edit(*this);
+        }
+        revision.fetch_add(1, std::memory_order::release);
+        state_epoch.fetch_add(1, std::memory_order::release);
+    }
 };
 
 } // namespace brun
@@ -0,0 +1,61 @@
+/**
+ * @author      : Riccardo Brugo (brugo.riccardo@gmail.com)
+ * @file        : culling
+ * @created     : Saturday Oct 17, 2026 19:20:44 CEST
+ * @license     : MIT
+ * */
+
+#ifndef CULLING_HPP
+#define CULLING_HPP
+
+#include <vector>
+#include <cstdint>
+
+#include <entt/entt.hpp>
+
+#include "common.hpp"
+#include "bounds.hpp"
+
+namespace brun
+{
+
+// A bounding volume hierarchy over the bodies, to find the ones in sight without looking at the others
+// The bodies are sorted along a Morton curve and split in leaves of consecutive bodies; node `i` bounds its
+//  children `2i` and `2i + 1`, and the leaves are the last nodes
+// Bodies move: rather than computing the boxes at every frame, they are grown by the distance a body may have
+//  covered since then, as the simulation reports it step by step. When they become too loose they are fit
+//  again to the bodies, and every few fits the bodies are sorted again
+class body_tree
+{
+    static constexpr auto leaf_size = std::size_t{64};
+    static constexpr auto fits_per_sort = 64;
+
+    std::vector<entt::entity> _bodies;
+    std::vector<brun::bounding_box> _nodes;
+    std::size_t _leaves = 0;
+    double _speed = 0.;             // the highest speed of a body, at the fit or in the last step [Gm/day]
+    double _travel = 0.;            // the travel of the simulation when the boxes were fit [Gm]
+    double _moved = 0.;             // how far a body may have gone since then [Gm]
+    std::uint64_t _revision = 0;
+    int _fits = 0;
+
+    void sort(entt::registry const & registry);
+    void fit(entt::registry const & registry, double travel);
+
+public:
+    // Makes the tree good enough for a query of radius `radius`; `revision` tells whether the bodies in
+    //  `registry` are the same of the last time, `travel` and `top_speed` are the ones of the context
+    void update(
+        entt::registry const & registry, std::uint64_t revision, double travel, double top_speed, double radius
+    );
+
+    // Appends to `out` the bodies which may be in the sphere of center `center` and radius `radius` [Gm],
+    //  when they are drawn up to `lead` days after the last state along their velocity
+    void query(
+        brun::position const & center, double radius, double lead, std::vector<entt::entity> & out
+    ) const;
+};
+
+} // namespace brun
+
+#endif /* CULLING_HPP */
@@ -0,0 +1,33 @@
+/**
+ * @author      : Riccardo Brugo (brugo.riccardo@gmail.com)
+ * @file        : density
+ * @created     : Saturday Oct 17, 2026 19:51:36 CEST
+ * @license     : MIT
+ * */
+
+#ifndef DENSITY_HPP
+#define DENSITY_HPP
+
+#include <span>
+#include <vector>
+
+namespace brun
+{
+
+// Counts the points which fall in every pixel of a screen, in parallel: every thread bins a part of the points
+//  in a grid of its own, and then the grids are summed
+// The grids are kept from a call to the next one
+class density_map
+{
+    std::vector<std::vector<float>> _tiles;
+
+public:
+    // Bins the points (`x[i]`, `y[i]`) [px] in `out`, row by row, `width` × `height`; returns the highest count
+    auto splat(
+        std::span<float const> x, std::span<float const> y, int width, int height, std::vector<float> & out
+    ) -> float;
+};
+
+} // namespace brun
+
+#endif /* DENSITY_HPP */
@@ -0,0 +1,35 @@
+/**
+ * @author      : Riccardo Brugo (brugo.riccardo@gmail.com)
+ * @file        : encoders
+ * @created     : Saturday Oct 17, 2026 23:48:22 CEST
+ * @license     : MIT
+ * */
+
+#ifndef ENCODERS_HPP
+#define ENCODERS_HPP
+
+#include <string>
+#include <vector>
+#include <cstdint>
+
+#include "raster.hpp"
+
+namespace brun
+{
+
+// A whole PNG file with the image, compressed with the fixed codes of deflate; the encoder looks for repeats
+//  only one pixel to the left and one row above, which is what a black sky with a few bodies needs
+auto encode_png(brun::rgb_image const & image)
+    -> std::vector<std::uint8_t>;
+
+// The header of a YUV4MPEG2 stream of `width`×`height` frames, `fps` per second, with full range samples
+auto y4m_header(int width, int height, int fps)
+    -> std::string;
+
+// A frame of a YUV4MPEG2 stream, 4:2:0 with the full range of BT.601 (as JPEG)
+auto encode_y4m_frame(brun::rgb_image const & image)
+    -> std::vector<std::uint8_t>;
+
+} // namespace brun
+
+#endif /* ENCODERS_HPP */
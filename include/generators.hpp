@@ -0,0 +1,46 @@
+/**
+ * @author      : Riccardo Brugo (brugo.riccardo@gmail.com)
+ * @file        : generators
+ * @created     : Saturday Oct 17, 2026 14:10:52 CEST
+ * @license     : MIT
+ * */
+
+#ifndef GENERATORS_HPP
+#define GENERATORS_HPP
+
+#include <vector>
+#include <string>
+#include <optional>
+#include <functional>
+#include <string_view>
+
+#include "scenario.hpp"
+#include "kepler.hpp"
+
+namespace brun
+{
+
+// Reads an attribute of a generator block, if it is present
+using number_source = std::function<std::optional<double>(std::string_view)>;
+using text_source   = std::function<std::optional<std::string>(std::string_view)>;
+
+// Builds a generator from a [[belt]], [[ring]] or [[cluster]] block (`section` is the name of the block)
+//  common:  count, seed, mass [Yg, of every body], name, parent
+//  belt:    inner, outer [Gm], max_eccentricity, max_inclination [deg]; needs a parent
+//  ring:    inner, outer, thickness [Gm]; needs a parent
+//  cluster: profile ("plummer" or "disk"), scale [Gm], thickness [Gm, disk only]; centered on the parent
+//            if there is one, on the origin otherwise
+auto make_generator(
+    std::string_view section, number_source const & number, text_source const & text,
+    brun::body_defaults const & defaults
+) -> brun::generator_spec;
+
+// Creates the bodies of a generator. They are produced in parallel chunks, and every chunk draws from
+//  its own random stream seeded by the seed of the generator and by the index of the chunk: the same
+//  generator always gives the same bodies, no matter how many threads are used
+auto expand_generator(brun::generator_spec const & spec, brun::parent_lookup const & find_parent)
+    -> std::vector<brun::body_record>;
+
+} // namespace brun
+
+#endif /* GENERATORS_HPP */
@@ -0,0 +1,79 @@
+/**
+ * @author      : Riccardo Brugo (brugo.riccardo@gmail.com)
+ * @file        : geometry
+ * @created     : Saturday Oct 17, 2026 16:48:31 CEST
+ * @license     : MIT
+ * */
+
+#ifndef GEOMETRY_HPP
+#define GEOMETRY_HPP
+
+#include <vector>
+#include <cstdint>
+
+#include <SDLpp/color.hpp>
+
+namespace brun
+{
+
+// Packs a color as four bytes, in the order r, g, b, a
+constexpr auto pack_color(std::uint8_t r, std::uint8_t g, std::uint8_t b, std::uint8_t a) noexcept
+    -> std::uint32_t
+{
+    return std::uint32_t{r} | std::uint32_t{g} << 8 | std::uint32_t{b} << 16 | std::uint32_t{a} << 24;
+}
+
+// A body on the screen: a disc centered in (x, y) [px]
+struct sprite
+{
+    float x;
+    float y;
+    float radius;
+    std::uint32_t color;
+};
+
+// A point of a motion trail on the screen [px]
+struct trail_vertex
+{
+    float x;
+    float y;
+    std::uint32_t color;
+};
+
+// How the trails of a frame are drawn
+enum class trail_pass : std::uint8_t
+{
+    full,           // the whole trails, over the black screen
+    rebuild,        // the whole trails, on the persistent canvas, which is cleared first
+    increment       // only the newest pieces of the trails, on the persistent canvas, after it fades
+};
+
+// Everything which is drawn in a frame, laid out as the GPU reads it
+// The vertices of the trails are stored one strip after the other: strip `i` starts at `firsts[i]` and
+//  has `counts[i]` vertices
+struct frame_geometry
+{
+    std::vector<brun::sprite> sprites;
+    std::vector<brun::trail_vertex> vertices;
+    std::vector<std::int32_t> firsts;
+    std::vector<std::int32_t> counts;
+    brun::trail_pass trails = brun::trail_pass::full;
+    float fade = 1.f;               // the fraction of the persistent canvas which is kept at this frame
+    // Test particles, as the number of them in every pixel of the screen (row by row, from the top); empty
+    //  when they are drawn one by one
+    std::vector<float> density;
+    float density_peak = 0.f;
+
+    void clear() noexcept
+    {
+        sprites.clear();
+        vertices.clear();
+        firsts.clear();
+        counts.clear();
+        density.clear();
+    }
+};
+
+} // namespace brun
+
+#endif /* GEOMETRY_HPP */
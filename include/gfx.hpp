@@ -8,14 +8,35 @@
 #ifndef GFX_HPP
 #define GFX_HPP
 
+#include <cstdint>
+
 #include "context.hpp"
+#include "gl_scene.hpp"
+#include "pacer.hpp"
+#include "prediction.hpp"
 #include <units/physical/si/derived/frequency.h>
 #include <SDLpp/texture.hpp>
 
 namespace brun
 {
 
-void draw_graphics(brun::context & ctx, SDLpp::renderer & renderer, SDLpp::window const & window);
+// Collects the geometry of a frame of `width`×`height` pixels, without persistent trails and without UI
+// With `splats` the test particles are drawn as a map of their density
+// The bodies are drawn at the last state, not blended with the time of the frame: the same state always
+//  gives the same frame
+void build_geometry(
+    brun::context const & ctx, int width, int height, bool splats, brun::frame_geometry & geometry
+);
+
+// Draws a frame: the bodies and their trails with `scene`, the UI with ImGui (with the frame times of `pacer`)
+//  and the trajectories of `predictor`, when they are asked for
+// `ui_epoch` changes with every input. When neither the inputs, the camera, the bodies nor the prediction
+//  changed, the frame is not drawn and false is returned; when only the UI changed, the bodies are drawn as
+//  in the last frame
+auto draw_graphics(
+    brun::context & ctx, SDLpp::renderer & renderer, SDLpp::window const & window, brun::gl_scene & scene,
+    brun::frame_pacer const & pacer, brun::trajectory_predictor & predictor, std::uint64_t ui_epoch
+) -> bool;
 
 
 } // namespace brun
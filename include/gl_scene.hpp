@@ -0,0 +1,98 @@
+/**
+ * @author      : Riccardo Brugo (brugo.riccardo@gmail.com)
+ * @file        : gl_scene
+ * @created     : Saturday Oct 17, 2026 16:52:10 CEST
+ * @license     : MIT
+ * */
+
+#ifndef GL_SCENE_HPP
+#define GL_SCENE_HPP
+
+#include <array>
+#include <cstddef>
+
+#include <GL/glew.h>
+
+#include "geometry.hpp"
+#include "raster.hpp"
+
+namespace brun
+{
+
+// A vertex buffer which is written by the CPU every frame
+// With ARB_buffer_storage the buffer is mapped once, persistently, and split in three regions which are
+//  used in turn, each protected by a fence; otherwise it is orphaned and filled at every frame
+class stream_buffer
+{
+    static constexpr auto regions = 3;
+    GLuint _id = 0;
+    std::size_t _region_size = 0;
+    void * _mapped = nullptr;
+    std::array<GLsync, regions> _fences = {};
+    int _current = 0;
+
+    void allocate(std::size_t region_size);
+    void release() noexcept;
+
+public:
+    stream_buffer() = default;
+    stream_buffer(stream_buffer const &) = delete;
+    auto operator=(stream_buffer const &) = delete;
+    ~stream_buffer() { release(); }
+
+    // Copies `size` bytes in the next free region; returns the offset of the region inside the buffer
+    auto push(void const * data, std::size_t size) -> GLintptr;
+    // To be called after the draw calls which read the last region
+    void fence();
+    auto id() const noexcept { return _id; }
+};
+
+// Draws the bodies and their trails with OpenGL: all the bodies with an instanced draw call, all the trails
+//  with a single multi-draw of line strips
+// Test particles may come as a map of their density, which is drawn as a single texture with a colormap
+// Persistent trails are drawn on an offscreen canvas, which is kept from a frame to the next one and copied
+//  on the screen under the bodies
+// Needs an OpenGL 4.3 context
+class gl_scene
+{
+    GLuint _sprite_program = 0;
+    GLuint _trail_program  = 0;
+    GLuint _fade_program   = 0;
+    GLuint _blit_program   = 0;
+    GLuint _density_program = 0;
+    GLuint _image_program  = 0;
+    GLuint _sprite_vao     = 0;
+    GLuint _trail_vao      = 0;
+    GLuint _screen_vao     = 0;
+    GLuint _canvas_fbo     = 0;
+    GLuint _canvas_texture = 0;
+    int _canvas_width  = 0;
+    int _canvas_height = 0;
+    GLuint _density_texture = 0;
+    int _density_width  = 0;
+    int _density_height = 0;
+    GLuint _image_texture = 0;
+    int _image_width  = 0;
+    int _image_height = 0;
+    stream_buffer _sprites;
+    stream_buffer _vertices;
+
+    void resize_canvas(int width, int height);
+    void draw_trails(brun::frame_geometry const & geometry, int width, int height);
+    void accumulate_trails(brun::frame_geometry const & geometry, int width, int height);
+    void draw_density(brun::frame_geometry const & geometry, int width, int height);
+
+public:
+    gl_scene();
+    gl_scene(gl_scene const &) = delete;
+    auto operator=(gl_scene const &) = delete;
+    ~gl_scene();
+
+    void draw(brun::frame_geometry const & geometry, int width, int height);
+    // Covers the screen with an image, e.g. a frame drawn by `software_scene`
+    void draw_image(brun::rgb_image const & image, int width, int height);
+};
+
+} // namespace brun
+
+#endif /* GL_SCENE_HPP */
@@ -0,0 +1,51 @@
+/**
+ * @author      : Riccardo Brugo (brugo.riccardo@gmail.com)
+ * @file        : injector
+ * @created     : Saturday Oct 17, 2026 16:12:27 CEST
+ * @license     : MIT
+ * */
+
+#ifndef INJECTOR_HPP
+#define INJECTOR_HPP
+
+#include <memory>
+#include <string>
+#include <thread>
+#include <cstdint>
+#include <filesystem>
+#include <string_view>
+
+#include "context.hpp"
+#include "scenario.hpp"
+#include "watcher.hpp"
+
+namespace brun
+{
+
+// Adds bodies to the running simulation, reading them from a named pipe or from a spool file which other
+//  processes append to. Every line is a body, in the format of the CSV catalogs:
+//  name, mass [Yg], x, y, z [Gm], vx, vy, vz [km/s] (, color (, px_radius))
+// Lines are parsed on a thread of the injector; the bodies are added by the simulation at the end of a step
+class body_injector
+{
+    brun::context & _ctx;
+    std::filesystem::path _path;
+    brun::body_defaults _defaults;
+    std::string _partial;           // the beginning of a line which is not complete yet
+    std::uint64_t _offset = 0;      // spool files: how much of the file has been read
+    std::unique_ptr<brun::file_watcher> _watcher;
+    std::jthread _thread;           // named pipes
+
+    void read_pipe(std::stop_token const & stop);
+    void read_spool();
+    void consume(std::string_view data);
+
+public:
+    body_injector(brun::context & ctx, std::filesystem::path path);
+    body_injector(body_injector const &) = delete;
+    auto operator=(body_injector const &) = delete;
+};
+
+} // namespace brun
+
+#endif /* INJECTOR_HPP */
@@ -0,0 +1,75 @@
+/**
+ * @author      : Riccardo Brugo (brugo.riccardo@gmail.com)
+ * @file        : interpolation
+ * @created     : Saturday Oct 17, 2026 22:58:40 CEST
+ * @license     : MIT
+ * */
+
+#ifndef INTERPOLATION_HPP
+#define INTERPOLATION_HPP
+
+#include <chrono>
+#include <algorithm>
+
+#include <units/physical/si/base/time.h>
+
+#include "common.hpp"
+#include "context.hpp"
+
+namespace brun
+{
+
+// The position of a body in the state published before the last one
+struct last_position
+{
+    brun::position value;
+};
+
+// Where the bodies are drawn between two states of the simulation, at a given time of the wall clock
+// The frames are drawn one state late: a frame moves the bodies from the previous state to the last one along
+//  with the time since the last state was published, so the motion does not stutter even when the states
+//  come slower than the frames. When the next state is late, the bodies move on with their velocity, for
+//  at most one more state
+struct blend
+{
+    double t = 1.;          // 0 => the previous state, 1 => the last one
+    double days = 0.;       // simulated time between the two states
+
+    // Whether the bodies stay where they are until the next state comes
+    auto still() const noexcept { return t >= 2. or days == 0.; }
+};
+
+// To be called under the shared lock of `ctx`
+inline
+auto make_blend(brun::context const & ctx, std::chrono::steady_clock::time_point const now)
+    -> brun::blend
+{
+    auto const & last = ctx.published;
+    if (last.interval <= std::chrono::steady_clock::duration::zero()) {
+        return {};
+    }
+    auto const t = std::chrono::duration<double>{now - last.time} / last.interval;
+    return {std::clamp(t, 0., 2.), last.days};
+}
+
+// The position of `entt` blended with `b`; a body with no previous state is moved back along its velocity
+inline
+auto blended_position(entt::registry const & registry, entt::entity const entt, brun::blend const & b)
+    -> brun::position
+{
+    auto const & position = registry.get<brun::position>(entt);
+    auto const * last = registry.try_get<brun::last_position>(entt);
+    if (b.t <= 1. and last != nullptr) {
+        return last->value + b.t * (position - last->value);
+    }
+    auto const * velocity = registry.try_get<brun::velocity>(entt);
+    if (velocity == nullptr) {
+        return position;
+    }
+    auto const dt = units::physical::si::time<units::physical::si::day>{(b.t - 1.) * b.days};
+    return position + *velocity * dt;
+}
+
+} // namespace brun
+
+#endif /* INTERPOLATION_HPP */
@@ -0,0 +1,44 @@
+/**
+ * @author      : Riccardo Brugo (brugo.riccardo@gmail.com)
+ * @file        : json_loader
+ * @created     : Saturday Oct 17, 2026 11:20:07 CEST
+ * @license     : MIT
+ * */
+
+#ifndef JSON_LOADER_HPP
+#define JSON_LOADER_HPP
+
+#ifndef GRAVITY_NO_JSON
+
+#include <vector>
+#include <functional>
+#include <filesystem>
+
+#include "scenario.hpp"
+#include "kepler.hpp"
+
+namespace brun
+{
+
+// Reads a JSON scenario with a SAX parser: the document is never fully loaded in memory, and the
+//  bodies are handed to `sink` in batches as soon as they are complete. Returns the trail density
+// The schema is the same of the TOML files:
+//  { "include": [...], "config": {...}, "object": [ { "name": ..., "mass": ..., "satellites": [...] }, ... ],
+//    "catalog": [ { "path": ..., "format": ... }, ... ], "belt": [ { "count": ..., ... } ], ... }
+// A top level array of objects is accepted as well
+// Objects and catalogs given by orbital elements look for their parent among the bodies already read, then
+//  with `find_parent`
+// The paths of an "include" list (relative to the scenario) are handed to `load_includes` as soon as the
+//  list ends, after the bodies read so far
+using include_loader = std::function<void(std::vector<std::filesystem::path> const &)>;
+auto stream_json(
+    std::filesystem::path const & data_path, body_sink const & sink, brun::parent_lookup const & find_parent,
+    include_loader const & load_includes
+) -> float;
+
+} // namespace brun
+
+#endif // GRAVITY_NO_JSON
+
+#endif /* JSON_LOADER_HPP */
+
@@ -0,0 +1,67 @@
+/**
+ * @author      : Riccardo Brugo (brugo.riccardo@gmail.com)
+ * @file        : kepler
+ * @created     : Saturday Oct 17, 2026 13:02:11 CEST
+ * @license     : MIT
+ * */
+
+#ifndef KEPLER_HPP
+#define KEPLER_HPP
+
+#include <span>
+#include <optional>
+#include <functional>
+#include <string_view>
+
+#include <entt/entt.hpp>
+
+#include "common.hpp"
+#include "scenario.hpp"
+
+namespace brun
+{
+
+// Classical elements of a bound orbit; angles are in degrees
+struct orbital_elements
+{
+    double a;               // semi-major axis [Gm]
+    double e;               // eccentricity, in [0, 1)
+    double i;               // inclination over the x-y plane
+    double node;            // longitude of the ascending node (Ω)
+    double peri;            // argument of periapsis (ω)
+    double mean_anomaly;    // mean anomaly (M)
+};
+
+// The body around which another one orbits
+struct orbital_parent
+{
+    brun::position position;
+    brun::velocity velocity;
+    brun::mass mass;
+};
+
+// Finds the parent of an orbit by name
+using parent_lookup = std::function<std::optional<brun::orbital_parent>(std::string_view)>;
+
+// Returns a description of what is wrong with some elements, if anything is
+auto check_elements(orbital_elements const & elements) noexcept -> std::optional<std::string_view>;
+
+// Sets position and velocity of every body from its orbital elements around `parent`
+// Bodies are processed in parallel blocks; inside a block Kepler's equation is solved for all the bodies
+//  at once, on a structure of arrays, with a fixed number of Newton iterations
+void place_on_orbits(
+    std::span<brun::body_record> bodies, std::span<orbital_elements const> elements, orbital_parent const & parent
+);
+
+// Position and velocity of a single body of mass `mass`
+auto orbit_state(orbital_elements const & elements, brun::mass mass, orbital_parent const & parent)
+    -> std::pair<brun::position, brun::velocity>;
+
+// Looks for a body with the given name in the registry
+auto find_orbital_parent(entt::registry const & registry, std::string_view name)
+    -> std::optional<brun::orbital_parent>;
+
+} // namespace brun
+
+#endif /* KEPLER_HPP */
+
@@ -0,0 +1,57 @@
+/**
+ * @author      : Riccardo Brugo (brugo.riccardo@gmail.com)
+ * @file        : names
+ * @created     : Saturday Oct 17, 2026 21:52:10 CEST
+ * @license     : MIT
+ * */
+
+#ifndef NAMES_HPP
+#define NAMES_HPP
+
+#include <span>
+#include <vector>
+#include <string_view>
+
+#include "common.hpp"
+
+namespace brun
+{
+
+// The names of the bodies, sorted without regard to case, to find a body while its name is being typed
+// The index is kept in the context of the registry: it changes only with the bodies, under the exclusive lock
+//  of the context, and is read under the shared one
+class name_index
+{
+    struct entry
+    {
+        brun::tag name;
+        entt::entity entity;
+    };
+    std::vector<entry> _entries;
+
+public:
+    // Adds the bodies just inserted, which must have a tag
+    void add(entt::registry const & registry, std::span<entt::entity const> entities);
+    // Drops the bodies about to be destroyed
+    void remove(std::span<entt::entity const> entities);
+
+    auto size() const noexcept { return _entries.size(); }
+
+    // At most `limit` bodies whose name matches `query`: first the ones starting with it, in order, then the
+    //  ones which contain its letters in the same order, the closest together first
+    // An empty query matches the first names
+    auto search(std::string_view query, std::size_t limit) const
+        -> std::vector<entt::entity>;
+};
+
+// The index of the names of the bodies in `registry`, or nullptr if there is none yet
+inline
+auto names(entt::registry const & registry)
+    -> brun::name_index const *
+{
+    return registry.try_ctx<brun::name_index>();
+}
+
+} // namespace brun
+
+#endif /* NAMES_HPP */
@@ -0,0 +1,65 @@
+/**
+ * @author      : Riccardo Brugo (brugo.riccardo@gmail.com)
+ * @file        : orbits
+ * @created     : Sunday Oct 18, 2026 01:04:19 CEST
+ * @license     : MIT
+ * */
+
+#ifndef ORBITS_HPP
+#define ORBITS_HPP
+
+#include <span>
+#include <array>
+#include <vector>
+#include <cstddef>
+
+#include <entt/entt.hpp>
+
+#include "common.hpp"
+#include "projection.hpp"
+
+namespace brun
+{
+
+// The orbit a body would follow around its parent if nothing else pulled it (its osculating orbit): an
+//  ellipse with a focus in the parent, given by its semi-major axis, its eccentricity and the directions of
+//  its periapsis (`p`) and of the velocity there (`q`)
+struct osculating_orbit
+{
+    entt::entity body;
+    entt::entity parent;
+    double a;                       // [Gm]
+    double e;                       // in [0, 1)
+    std::array<double, 3> p;
+    std::array<double, 3> q;
+
+    // The point of the orbit at eccentric anomaly `E`, relative to the parent
+    auto at(double E) const noexcept -> brun::position;
+};
+
+// The length of the trail of a body whose path is drawn as an orbit: the trail itself keeps a single point
+//  until the body is drawn with its trail again
+struct parked_trail
+{
+    std::size_t length;
+};
+
+// Finds the parent of every body with a trail and its orbit around it, in a batch; the bodies which are not
+//  bound to a parent, or which would leave its sphere of influence, are left out
+// Parents are looked for among the heaviest bodies: each one is the lightest of them, heavier than the body,
+//  whose sphere of influence holds it
+void compute_orbits(entt::registry const & registry, std::vector<brun::osculating_orbit> & out);
+
+// Appends the orbit around `focus`, projected, to `out`, as a closed polyline: pieces are split until they
+//  stray from the conic by less than `tolerance` pixels
+void trace_orbit(
+    brun::osculating_orbit const & orbit, brun::position const & focus, brun::projection const & view,
+    float tolerance, brun::projected_points & out
+);
+
+// Parks the trails of the bodies in `bound` (sorted), and gives back their length to the other ones
+void park_trails(entt::registry & registry, std::span<entt::entity const> bound);
+
+} // namespace brun
+
+#endif /* ORBITS_HPP */
@@ -0,0 +1,76 @@
+/**
+ * @author      : Riccardo Brugo (brugo.riccardo@gmail.com)
+ * @file        : pacer
+ * @created     : Saturday Oct 17, 2026 22:24:31 CEST
+ * @license     : MIT
+ * */
+
+#ifndef PACER_HPP
+#define PACER_HPP
+
+#include <array>
+#include <chrono>
+#include <cstdio>
+#include <cstdint>
+
+namespace brun
+{
+
+// The time between two frames, counted in buckets of 0.1 ms up to 100 ms; longer frames share the last one
+class frame_histogram
+{
+public:
+    using milliseconds = std::chrono::duration<double, std::milli>;
+
+private:
+    static constexpr auto bucket_width = 0.1;   // ms
+    static constexpr auto bucket_count = std::size_t{1000};
+
+    std::array<std::uint32_t, bucket_count + 1> _counts = {};
+    std::uint64_t _frames = 0;
+    milliseconds _max = milliseconds{0.};
+
+public:
+    void record(milliseconds time) noexcept;
+
+    auto frames() const noexcept { return _frames; }
+    auto max() const noexcept { return _max; }
+    // The time which the fraction `p` of the frames does not exceed (the upper edge of its bucket)
+    auto percentile(double p) const noexcept -> milliseconds;
+
+    // Prints the percentiles and the frames in every millisecond
+    void dump(std::FILE * out) const;
+};
+
+// Keeps the frames `1 / fps` apart: it sleeps until the next frame is due, and when it falls behind by more
+//  than a frame it drops the lost ones instead of drawing them in a burst
+class frame_pacer
+{
+public:
+    using clock = std::chrono::steady_clock;
+
+private:
+    clock::duration _period;
+    clock::time_point _deadline;
+    clock::time_point _last_frame;      // when the last frame drawn began; none after a skipped one
+    std::uint64_t _dropped = 0;
+    std::uint64_t _skipped = 0;
+    brun::frame_histogram _histogram;
+
+public:
+    explicit frame_pacer(double fps);
+
+    // Waits for the next frame, and records the time since the previous one drawn
+    void wait();
+    // The frame was not drawn (i.e. nobody would see it): the next one starts a new measure
+    void skip() noexcept;
+
+    auto period()    const noexcept { return _period; }
+    auto dropped()   const noexcept { return _dropped; }
+    auto skipped()   const noexcept { return _skipped; }
+    auto histogram() const noexcept -> brun::frame_histogram const & { return _histogram; }
+};
+
+} // namespace brun
+
+#endif /* PACER_HPP */
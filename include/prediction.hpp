@@ -0,0 +1,111 @@
+/**
+ * @author      : Riccardo Brugo (brugo.riccardo@gmail.com)
+ * @file        : prediction
+ * @created     : Sunday Oct 18, 2026 01:41:26 CEST
+ * @license     : MIT
+ * */
+
+#ifndef PREDICTION_HPP
+#define PREDICTION_HPP
+
+#include <span>
+#include <array>
+#include <atomic>
+#include <thread>
+#include <vector>
+#include <cstdint>
+
+#include <entt/entt.hpp>
+
+#include "common.hpp"
+#include "context.hpp"
+
+namespace brun
+{
+
+// Hands the latest value from a single writer to a single reader, without locks: the writer fills its own
+//  slot and swaps it with the middle one, the reader takes the middle one when it holds something new
+template <typename T>
+class handoff
+{
+    static constexpr auto fresh = std::uint8_t{4};
+    static constexpr auto index = std::uint8_t{3};
+
+    std::array<T, 3> _slots = {};
+    std::atomic<std::uint8_t> _middle = 1;
+    std::uint8_t _back = 0;         // the writer's slot
+    std::uint8_t _front = 2;        // the reader's slot
+
+public:
+    // To be called by the writer only
+    auto back() noexcept -> T & { return _slots[_back]; }
+    void publish() noexcept
+    {
+        _back = _middle.exchange(_back | fresh, std::memory_order::acq_rel) & index;
+    }
+
+    // To be called by the reader only: the latest value published, which stays valid until the next call
+    auto front() noexcept -> T const &
+    {
+        if ((_middle.load(std::memory_order::relaxed) & fresh) != 0) {
+            _front = _middle.exchange(_front, std::memory_order::acq_rel) & index;
+        }
+        return _slots[_front];
+    }
+};
+
+// Where the bodies with a trail will be in the next `horizon` days: `samples` points for every body, at
+//  regular times, from the state at `start`
+struct trajectories
+{
+    double start = 0.;              // simulated time [days]
+    double horizon = 0.;            // [days]
+    std::size_t samples = 0;
+    std::vector<entt::entity> bodies;
+    std::vector<brun::position> points;     // body after body
+
+    auto path(std::size_t const k) const noexcept
+    {
+        return std::span{points}.subspan(k * samples, samples);
+    }
+};
+
+// Predicts the trajectories of the bodies on its own thread, from a copy of the state: a leapfrog
+//  integration with a step of `horizon / (samples · substeps)`, far longer than the one of the simulation
+// A prediction is started again when the state is edited or the horizon changes (it is dropped half way),
+//  and when the simulation has gone past its first sample (it is published first)
+class trajectory_predictor
+{
+public:
+    static constexpr auto samples = std::size_t{256};
+    static constexpr auto substeps = 4;
+
+private:
+    brun::context & _ctx;
+    std::atomic<bool> _enabled = false;
+    std::atomic<double> _horizon = 365.;            // [days]
+    std::atomic<std::uint64_t> _published = 0;
+    brun::handoff<brun::trajectories> _latest;
+    std::jthread _worker;
+
+    void work(std::stop_token const & stop);
+
+public:
+    explicit trajectory_predictor(brun::context & ctx);
+    trajectory_predictor(trajectory_predictor const &) = delete;
+    auto operator=(trajectory_predictor const &) = delete;
+
+    auto enabled() const noexcept { return _enabled.load(std::memory_order::relaxed); }
+    void enable(bool const on) noexcept { _enabled.store(on, std::memory_order::relaxed); }
+    auto horizon() const noexcept { return _horizon.load(std::memory_order::relaxed); }
+    void set_horizon(double const days) noexcept { _horizon.store(days, std::memory_order::relaxed); }
+
+    // Counts the predictions published so far
+    auto published() const noexcept { return _published.load(std::memory_order::acquire); }
+    // The latest prediction; to be called by a single thread. Empty while disabled
+    auto latest() noexcept -> brun::trajectories const & { return _latest.front(); }
+};
+
+} // namespace brun
+
+#endif /* PREDICTION_HPP */
@@ -0,0 +1,51 @@
+/**
+ * @author      : Riccardo Brugo (brugo.riccardo@gmail.com)
+ * @file        : projection
+ * @created     : Saturday Oct 17, 2026 18:32:47 CEST
+ * @license     : MIT
+ * */
+
+#ifndef PROJECTION_HPP
+#define PROJECTION_HPP
+
+#include <span>
+#include <array>
+#include <vector>
+#include <cstddef>
+
+#include "common.hpp"
+
+namespace brun
+{
+
+// The map from a position to the screen, as a 3×4 matrix acting on (x, y, z, 1) [Gm]: the positions are moved
+//  to the origin of the camera, scaled to pixels and rotated, all at once
+// The first two rows give the coordinates on the screen, relative to its center, the third one the distance
+//  from the plane of the screen [px]
+struct projection
+{
+    std::array<std::array<double, 4>, 3> m;
+    float center_x;     // the center of the screen [px]
+    float center_y;
+};
+
+auto make_projection(
+    brun::position const & origin, brun::rotation_matrix const & rotation, double px_per_Gm, int width, int height
+) -> brun::projection;
+
+// Points on the screen, as a structure of arrays: `x` and `y` are the coordinates on the screen, `distance2` is
+//  the square of the distance from the center of the screen (in 3D, so that it doesn't change with the
+//  rotation) [px]
+struct projected_points
+{
+    std::vector<float> x;
+    std::vector<float> y;
+    std::vector<float> distance2;
+};
+
+// Projects every point of `points` in `out`, with a vectorizable loop; many points are split across threads
+void project(brun::projection const & view, std::span<brun::position const> points, brun::projected_points & out);
+
+} // namespace brun
+
+#endif /* PROJECTION_HPP */
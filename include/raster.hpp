@@ -0,0 +1,58 @@
+/**
+ * @author      : Riccardo Brugo (brugo.riccardo@gmail.com)
+ * @file        : raster
+ * @created     : Saturday Oct 17, 2026 23:31:05 CEST
+ * @license     : MIT
+ * */
+
+#ifndef RASTER_HPP
+#define RASTER_HPP
+
+#include <vector>
+#include <cstdint>
+
+#include "geometry.hpp"
+
+namespace brun
+{
+
+// An image in memory: 8 bits per channel, RGB, row by row from the top
+struct rgb_image
+{
+    int width = 0;
+    int height = 0;
+    std::vector<std::uint8_t> pixels;
+};
+
+// Draws the geometry of a frame on the CPU, as `gl_scene` does on the GPU: the trails as line strips, then
+//  the density of the test particles, then the bodies as discs with one pixel of antialiasing
+// The screen is split in tiles, which are drawn in parallel: every primitive is first listed in the tiles it
+//  touches, and every tile then draws its own, in order. The image doesn't depend on the number of threads
+// There is no persistent canvas: every pass of the trails is drawn as a full one
+class software_scene
+{
+public:
+    static constexpr auto tile_size = 64;   // px
+
+private:
+    struct tile
+    {
+        int x0, y0, x1, y1;                     // [x0, x1) × [y0, y1)
+        std::vector<std::uint32_t> segments;    // the first vertex of every piece of trail
+        std::vector<std::uint32_t> sprites;
+    };
+
+    std::vector<float> _color;      // r, g, b of every pixel, in [0, 1]
+    std::vector<brun::software_scene::tile> _tiles;
+    int _columns = 0;
+    int _rows = 0;
+
+    void bin(brun::frame_geometry const & geometry, int width, int height);
+
+public:
+    void draw(brun::frame_geometry const & geometry, int width, int height, brun::rgb_image & out);
+};
+
+} // namespace brun
+
+#endif /* RASTER_HPP */
@@ -0,0 +1,25 @@
+/**
+ * @author      : Riccardo Brugo (brugo.riccardo@gmail.com)
+ * @file        : recorder
+ * @created     : Sunday Oct 18, 2026 00:12:47 CEST
+ * @license     : MIT
+ * */
+
+#ifndef RECORDER_HPP
+#define RECORDER_HPP
+
+#include "context.hpp"
+#include "simulation_params.hpp"
+
+namespace brun
+{
+
+// Renders the simulation without a window, on the CPU, and writes the frames as a Y4M video or as PNG files
+//  (see `record_params`): a frame every 1/fps seconds of simulation, so that the video runs at the speed of
+//  the simulation. The frames are encoded by a pool of threads
+// To be invoked in a thread, instead of `render_cycle`; it stops the simulation after the last frame
+void record_cycle(brun::context & ctx, simulation_params const & params) noexcept;
+
+} // namespace brun
+
+#endif /* RECORDER_HPP */
@@ -0,0 +1,58 @@
+/**
+ * @author      : Riccardo Brugo (brugo.riccardo@gmail.com)
+ * @file        : reload
+ * @created     : Saturday Oct 17, 2026 15:21:44 CEST
+ * @license     : MIT
+ * */
+
+#ifndef RELOAD_HPP
+#define RELOAD_HPP
+
+#include <span>
+#include <vector>
+#include <filesystem>
+
+#include "context.hpp"
+#include "scenario.hpp"
+#include "watcher.hpp"
+
+namespace brun
+{
+
+// What changed between two versions of a scenario, object by object (objects are matched by name)
+struct scenario_diff
+{
+    std::vector<brun::body_record> added;
+    std::vector<std::string>       removed;
+    std::vector<brun::body_record> changed;     // only mass, color, radius and trail are applied
+
+    auto empty() const noexcept { return added.empty() and removed.empty() and changed.empty(); }
+};
+
+auto diff_bodies(std::span<brun::body_record const> before, std::span<brun::body_record const> after)
+    -> scenario_diff;
+
+// Applies a diff to the registry; positions and velocities of the objects which are still there are kept
+void apply_diff(brun::context & ctx, scenario_diff diff);
+
+// Watches the files of a scenario (the scenario and the files it includes); every time one of them is saved,
+//  the scenario is read again and the differences are applied to the running simulation at the end of a step
+// A file which can't be read, or whose content is not valid, is reported and skipped: the running scenario is
+//  kept as it is. Catalogs and generators are expanded again at every reload, as a catalog may have changed
+//  without touching the files which are watched
+class scenario_reloader
+{
+    brun::context & _ctx;
+    std::vector<std::filesystem::path> _files;  // the scenario first, then its includes
+    std::vector<brun::body_record> _bodies;     // as they were read the last time
+    brun::file_watcher _watcher;
+
+    void reload();
+
+public:
+    scenario_reloader(brun::context & ctx, std::vector<std::filesystem::path> files);
+};
+
+} // namespace brun
+
+#endif /* RELOAD_HPP */
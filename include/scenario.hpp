@@ -0,0 +1,99 @@
+/**
+ * @author      : Riccardo Brugo (brugo.riccardo@gmail.com)
+ * @file        : scenario
+ * @created     : Saturday Oct 17, 2026 10:12:40 CEST
+ * @license     : MIT
+ * */
+
+#ifndef SCENARIO_HPP
+#define SCENARIO_HPP
+
+#include <string>
+#include <vector>
+#include <functional>
+#include <filesystem>
+
+#include <entt/entt.hpp>
+#include <SDLpp/color.hpp>
+
+#include "common.hpp"
+
+namespace brun
+{
+
+// A body as described by a scenario file, before it becomes an entity of the registry
+struct body_record
+{
+    std::string     name;
+    brun::mass      mass;
+    brun::position  position;
+    brun::velocity  velocity;
+    SDLpp::color    color;
+    brun::px_radius px_radius;
+    int32_t         trail_size;     // number of points of the motion trail (0 => no trail)
+};
+
+// Attributes given to the bodies of a catalog when the catalog does not specify them
+struct body_defaults
+{
+    SDLpp::color    color;
+    brun::px_radius px_radius;
+    int32_t         trail_size;
+};
+
+// A list of bodies stored in an external file and referenced by a scenario
+struct catalog_ref
+{
+    enum class format : uint8_t { csv, binary, elements };
+    std::filesystem::path path;
+    format kind;
+    body_defaults defaults;
+    std::string parent;     // the body around which the bodies orbit, for catalogs of orbital elements
+};
+
+// A block which creates a population of bodies from a random distribution
+struct generator_spec
+{
+    enum class shape : uint8_t { belt, ring, plummer, disk };
+    shape kind;
+    std::string name;       // the bodies are named "<name> <index>"
+    std::string parent;     // the body they orbit, or the center of the cluster
+    std::uint64_t count;
+    std::uint64_t seed;
+    double mass;            // of every body [Yg]
+    double inner;           // belts and rings [Gm]
+    double outer;
+    double eccentricity;    // belts, maximum
+    double inclination;     // belts, maximum [deg]
+    double thickness;       // rings and disks, vertical scale [Gm]
+    double scale;           // Plummer radius or disk scale length [Gm]
+    body_defaults defaults;
+};
+
+// The content of a scenario file, in the order in which the bodies were declared
+struct scenario
+{
+    std::vector<body_record> bodies;
+    std::vector<catalog_ref> catalogs;
+    std::vector<generator_spec> generators;
+    std::vector<std::filesystem::path> includes;    // other scenarios, whose bodies come before these
+    float trail_density;
+};
+
+// Thrown by the loaders when a scenario can't be read, once the reason has been printed: at startup it ends
+//  the program with `status`, while a reload keeps the bodies it has
+struct load_error
+{
+    int status;
+};
+
+// Receives the bodies of a scenario a batch at a time, while the file is still being read
+using body_sink = std::function<void(std::vector<brun::body_record> &&)>;
+
+// Creates an entity for every record; components are added with one bulk insertion per type
+void insert_bodies(entt::registry & registry, std::vector<body_record> bodies);
+
+} // namespace brun
+
+#endif /* SCENARIO_HPP */
+
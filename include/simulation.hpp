@@ -34,7 +34,11 @@ inline namespace constants
     auto G = G_type<Length, Mass, Force>{G_type<>{6.67e-11}};
 } // namespace constants
 
-void simulation(brun::context & ctx, units::physical::si::time<units::physical::si::day> const days_per_second);
+// Runs the simulation; the motion trails take `points_per_day` samples every simulated day
+void simulation(
+    brun::context & ctx, units::physical::si::time<units::physical::si::day> const days_per_second,
+    float const points_per_day
+);
 
 } // namespace brun
 
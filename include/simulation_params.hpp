@@ -14,6 +14,16 @@
 namespace brun
 {
 
+// Frames rendered without a window, and written to files
+struct record_params
+{
+    std::string path;           // "<name>.y4m" for a video, or a pattern for PNG files as "frame_{:05}.png"
+    std::uint64_t frames = 0;   // 0 => until the simulation ends
+    int width = 1280;
+    int height = 720;
+    bool density = false;       // draw the test particles as a map of their density
+};
+
 struct simulation_params
 {
     units::physical::si::time<units::physical::si::day> days_per_second;
@@ -21,6 +31,11 @@ struct simulation_params
     float points_per_day;
     brun::position_scalar view_radius;
     std::string filename;
+    bool watch;             // reload the scenario when its file changes
+    std::string inject;     // named pipe or spool file where new bodies are read from
+    double trail_tolerance; // how far a trail may stray from the path, relative to its pieces (0 => uniform)
+    std::size_t trail_budget;   // maximum number of points of a trail (0 => no limit)
+    brun::record_params record; // empty path => the frames are drawn in a window
 };
 
 } // namespace brun
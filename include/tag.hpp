@@ -0,0 +1,70 @@
+/**
+ * @author      : Riccardo Brugo (brugo.riccardo@gmail.com)
+ * @file        : tag
+ * @created     : Saturday Oct 17, 2026 21:36:48 CEST
+ * @license     : MIT
+ * */
+
+#ifndef TAG_HPP
+#define TAG_HPP
+
+#include <string>
+#include <cstdint>
+#include <string_view>
+
+#include <fmt/format.h>
+
+namespace brun
+{
+
+// Stores a copy of `name` in the pool of the names, unless it is there already, and returns it
+// The pool never shrinks and its strings never move, so a name can be read without locks once interned;
+//  the names of the bodies removed by a reload are found again when they come back
+auto intern(std::string_view name)
+    -> std::string_view;
+
+// The string of every empty name: it isn't in the pool, but it has a single address too
+inline constexpr char empty_name[] = "";
+
+// The name of a body: a view of its string in the pool, which is shared by all the bodies with the same name
+class tag
+{
+    char const * _data = brun::empty_name;
+    std::uint32_t _size = 0;
+
+public:
+    tag() = default;
+    explicit tag(std::string_view const name)
+    {
+        if (name.empty()) {
+            return;
+        }
+        auto const interned = brun::intern(name);
+        _data = interned.data();
+        _size = static_cast<std::uint32_t>(interned.size());
+    }
+
+    auto view()  const noexcept { return std::string_view{_data, _size}; }
+    auto c_str() const noexcept { return _data; }           // interned strings are null terminated
+    auto size()  const noexcept { return static_cast<std::size_t>(_size); }
+    auto empty() const noexcept { return _size == 0; }
+    operator std::string_view() const noexcept { return view(); }
+
+    // Two equal names are the same string of the pool
+    friend auto operator==(tag const lhs, tag const rhs) noexcept { return lhs._data == rhs._data; }
+    friend auto operator==(tag const lhs, std::string_view const rhs) noexcept { return lhs.view() == rhs; }
+};
+
+} // namespace brun
+
+template <>
+struct fmt::formatter<brun::tag> : fmt::formatter<std::string_view>
+{
+    template <typename FormatContext>
+    auto format(brun::tag const & name, FormatContext & ctx)
+    {
+        return fmt::formatter<std::string_view>::format(name.view(), ctx);
+    }
+};
+
+#endif /* TAG_HPP */
@@ -0,0 +1,297 @@
+/**
+ * @author      : Riccardo Brugo (brugo.riccardo@gmail.com)
+ * @file        : trail
+ * @created     : Saturday Oct 17, 2026 17:40:12 CEST
+ * @license     : MIT
+ * */
+
+#ifndef TRAIL_HPP
+#define TRAIL_HPP
+
+#include <span>
+#include <cmath>
+#include <array>
+#include <vector>
+#include <cstddef>
+#include <cstdint>
+#include <algorithm>
+
+#include "common.hpp"
+#include "bounds.hpp"
+
+namespace brun
+{
+
+// The past positions of a body, sampled at a regular pace: a ring buffer whose newest point is `_head`
+// A trail covers its last `length` samples. A uniform trail keeps all of them; an adaptive one keeps a
+//  sample only where the path bends away from a straight line by more than `tolerance` (relative to the
+//  length of the line), and never more than `budget` points - the oldest ones are dropped first
+// The ring of a uniform trail, or of one with a budget, never allocates after it is sized; the one of an
+//  adaptive trail without a budget starts small and doubles when its points are all in the span, up to a slot
+//  per sample. Every chunk of its slots has a bounding box, so that readers can skip whole pieces of trail
+//  which are out of sight
+class trail
+{
+public:
+    struct policy
+    {
+        double tolerance = 0.;      // 0 => every sample is kept
+        std::size_t budget = 0;     // 0 => as many points as samples
+    };
+
+private:
+    // The samples merged into the newest point are checked again at every new sample: at most this many
+    static constexpr auto window_size = std::size_t{32};
+    static constexpr auto chunk_size = std::size_t{64};
+    // The slots an adaptive trail without a budget starts with
+    static constexpr auto adaptive_slots = std::size_t{64};
+
+    std::vector<brun::position> _points;
+    std::vector<std::int64_t> _stamps;      // the sample every point was taken at
+    std::size_t _head = 0;
+    std::size_t _size = 0;
+    std::int64_t _clock = 0;                // the last sample taken
+    std::int64_t _span = 0;                 // samples between the first and the last point
+    brun::trail::policy _policy;
+    std::vector<brun::position> _window;    // the samples between the two newest points
+    std::vector<brun::bounding_box> _boxes; // the box of every chunk of slots
+
+    auto slot(std::size_t const i) const noexcept
+    {
+        auto const k = _head + i;
+        return k < _points.size() ? k : k - _points.size();
+    }
+
+    // The box of a chunk is computed again when the head (which moves backward) enters it, and grown after
+    void rebox(std::size_t const chunk) noexcept
+    {
+        auto & box = _boxes[chunk];
+        box = brun::bounding_box{};
+        auto const last = std::min((chunk + 1) * chunk_size, _points.size());
+        for (auto s = chunk * chunk_size; s < last; ++s) {
+            box.expand(_points[s]);
+        }
+    }
+
+    void written(std::size_t const s) noexcept
+    {
+        if (s % chunk_size == chunk_size - 1 or s == _points.size() - 1) {
+            rebox(s / chunk_size);
+        } else {
+            _boxes[s / chunk_size].expand(_points[s]);
+        }
+    }
+
+    // Distance of `x` from the segment from `a` to `b`, and length of the segment
+    static auto deviation(brun::position const & x, brun::position const & a, brun::position const & b) noexcept
+        -> std::pair<double, double>
+    {
+        auto const ab = std::array{(b[0] - a[0]).count(), (b[1] - a[1]).count(), (b[2] - a[2]).count()};
+        auto const ax = std::array{(x[0] - a[0]).count(), (x[1] - a[1]).count(), (x[2] - a[2]).count()};
+        auto const length2 = ab[0] * ab[0] + ab[1] * ab[1] + ab[2] * ab[2];
+        auto const t = length2 > 0 ? std::clamp((ax[0] * ab[0] + ax[1] * ab[1] + ax[2] * ab[2]) / length2, 0., 1.) : 0.;
+        auto distance2 = 0.;
+        for (auto k = 0ul; k < 3; ++k) {
+            auto const d = ax[k] - t * ab[k];
+            distance2 += d * d;
+        }
+        return {std::sqrt(distance2), std::sqrt(length2)};
+    }
+
+    // Whether the newest point must stay where it is for the path to reach `p`
+    auto bends(brun::position const & p) const noexcept
+    {
+        if (_window.size() >= window_size) {
+            return true;
+        }
+        auto const & anchor = (*this)[1];
+        auto const limit = [&](brun::position const & x) {
+            auto const [distance, length] = deviation(x, anchor, p);
+            return distance > _policy.tolerance * length;
+        };
+        return limit((*this)[0]) or std::ranges::any_of(_window, limit);
+    }
+
+    // The most slots the span and the policy may ask for, and the ones a trail is sized with
+    auto max_slots() const noexcept
+    {
+        auto const samples = static_cast<std::size_t>(_span) + 1;
+        return _policy.budget > 0 ? std::min(_policy.budget, samples) : samples;
+    }
+    auto initial_slots() const noexcept
+    {
+        auto const grows = _policy.tolerance > 0 and _policy.budget == 0;
+        return grows ? std::min(std::max(adaptive_slots, _size), max_slots()) : max_slots();
+    }
+
+    auto filler() const noexcept { return _size > 0 ? _points[_head] : brun::position{} * 0.; }
+
+    void insert(brun::position const & p)
+    {
+        if (_size == _points.size() and _points.size() < max_slots()) {
+            reshape(filler(), std::min(2 * _points.size(), max_slots()));
+        }
+        _head = (_head == 0 ? _points.size() : _head) - 1;
+        _points[_head] = p;
+        _stamps[_head] = _clock;
+        _size = std::min(_size + 1, _points.size());
+        written(_head);
+    }
+
+    // Drops the points older than the span; the oldest one is moved back along the path to the span's edge
+    void expire() noexcept
+    {
+        auto const cutoff = _clock - _span;
+        while (_size >= 2 and _stamps[slot(_size - 2)] <= cutoff) {
+            --_size;
+        }
+        if (_size < 2) {
+            return;
+        }
+        auto const oldest = slot(_size - 1), next = slot(_size - 2);
+        if (auto const stamp = _stamps[oldest]; stamp < cutoff) {
+            auto const t = static_cast<double>(cutoff - stamp) / static_cast<double>(_stamps[next] - stamp);
+            _points[oldest] = _points[oldest] + t * (_points[next] - _points[oldest]);
+            _stamps[oldest] = cutoff;
+            _boxes[oldest / chunk_size].expand(_points[oldest]);
+        }
+    }
+
+    // Keeps the newest points which fit in `capacity` slots; the free slots are filled with `fill`
+    void reshape(brun::position const & fill, std::size_t const capacity)
+    {
+        auto const n = std::min(_size, capacity);
+        auto points = std::vector<brun::position>(capacity, fill);
+        auto stamps = std::vector<std::int64_t>(capacity);
+        for (auto i = 0ul; i < n; ++i) {
+            points[i] = (*this)[i];
+            stamps[i] = _stamps[slot(i)];
+        }
+        _points = std::move(points);
+        _stamps = std::move(stamps);
+        _head = 0;
+        _size = n;
+        _window.clear();
+        _window.reserve(_policy.tolerance > 0 ? window_size : 0);
+        _boxes.resize((capacity + chunk_size - 1) / chunk_size);
+        for (auto chunk = 0ul; chunk < _boxes.size(); ++chunk) {
+            rebox(chunk);
+        }
+        expire();
+    }
+
+public:
+    trail() = default;
+    // The default policy can't be a default argument: `policy` is not complete until the trail is
+    trail(std::size_t const length, brun::position const & start)
+        : trail{length, start, brun::trail::policy{}}
+    {
+    }
+    trail(std::size_t const length, brun::position const & start, brun::trail::policy const & policy)
+        : _span{static_cast<std::int64_t>(std::max(length, std::size_t{1})) - 1}, _policy{policy}
+    {
+        reshape(start, initial_slots());
+        insert(start);
+    }
+
+    auto size() const noexcept { return _size; }
+    auto empty() const noexcept { return _size == 0; }
+    // The number of samples covered by the trail
+    auto length() const noexcept { return static_cast<std::size_t>(_span) + 1; }
+
+    // Point `i` is `i` points in the past: 0 is the newest one, `size() - 1` the oldest one
+    auto operator[](std::size_t const i) const noexcept
+        -> brun::position const &
+    {
+        return _points[slot(i)];
+    }
+    auto front() const noexcept -> brun::position const & { return (*this)[0]; }
+    auto back()  const noexcept -> brun::position const & { return (*this)[_size - 1]; }
+
+    // How old point `i` is, as a fraction of the length of the trail
+    auto age(std::size_t const i) const noexcept
+    {
+        return _span > 0 ? static_cast<double>(_clock - _stamps[slot(i)]) / static_cast<double>(_span) : 0.;
+    }
+
+    // The points, from the newest to the oldest, as two contiguous pieces (the second one may be empty)
+    auto segments() const noexcept
+        -> std::array<std::span<brun::position const>, 2>
+    {
+        auto const all = std::span{_points};
+        auto const first = std::min(_size, _points.size() - _head);
+        return {all.subspan(_head, first), all.first(_size - first)};
+    }
+
+    // Calls `f(points, first, box)` on the points from the newest to the oldest, in contiguous pieces bounded
+    //  by `box`: `first` is the index of the first point of the piece
+    template <typename Function>
+    void for_each_chunk(Function && f) const
+    {
+        auto i = 0ul;
+        for (auto const segment : segments()) {
+            auto const base = static_cast<std::size_t>(segment.data() - _points.data());
+            for (auto k = 0ul; k < segment.size(); ) {
+                auto const chunk = (base + k) / chunk_size;
+                auto const end = std::min(segment.size(), (chunk + 1) * chunk_size - base);
+                f(segment.subspan(k, end - k), i + k, _boxes[chunk]);
+                k = end;
+            }
+            i += segment.size();
+        }
+    }
+
+    // Takes a new sample: the head moves backward, so that the points are read forward from the newest one
+    // A point between two others on a straight line is moved forward instead
+    void push(brun::position const & p)
+    {
+        ++_clock;
+        if (_points.empty()) {
+            return;
+        }
+        if (_policy.tolerance > 0 and _size >= 2 and not bends(p)) {
+            _window.push_back(_points[_head]);
+            _points[_head] = p;
+            _stamps[_head] = _clock;
+            _boxes[_head / chunk_size].expand(p);
+        } else {
+            _window.clear();
+            insert(p);
+        }
+        expire();
+    }
+
+    // Changes the number of samples covered, keeping the newest points
+    void resize(std::size_t const length)
+    {
+        _span = static_cast<std::int64_t>(std::max(length, std::size_t{1})) - 1;
+        reshape(filler(), initial_slots());
+    }
+
+    void set_policy(brun::trail::policy const & policy)
+    {
+        _policy = policy;
+        reshape(filler(), initial_slots());
+    }
+};
+
+// The policy of the trails of the bodies in `registry`, kept in its context
+inline
+auto trail_policy(entt::registry const & registry)
+    -> brun::trail::policy
+{
+    auto const * policy = registry.try_ctx<brun::trail::policy>();
+    return policy != nullptr ? *policy : brun::trail::policy{};
+}
+
+// Sets the policy of the trails in `registry`, for the bodies already there and for the ones to come
+inline
+void set_trail_policy(entt::registry & registry, brun::trail::policy const & policy)
+{
+    registry.set<brun::trail::policy>(policy);
+    registry.view<brun::trail>().each([&policy](auto & t) { t.set_policy(policy); });
+}
+
+} // namespace brun
+
+#endif /* TRAIL_HPP */
@@ -0,0 +1,46 @@
+/**
+ * @author      : Riccardo Brugo (brugo.riccardo@gmail.com)
+ * @file        : watcher
+ * @created     : Saturday Oct 17, 2026 15:02:38 CEST
+ * @license     : MIT
+ * */
+
+#ifndef WATCHER_HPP
+#define WATCHER_HPP
+
+#include <thread>
+#include <cstdint>
+#include <vector>
+#include <functional>
+#include <filesystem>
+
+namespace brun
+{
+
+// Watches some files with inotify, on a thread of its own, and calls `on_change` with the path of every
+//  file which has been rewritten (or, with `trigger::modified`, which has been written at all, as it
+//  happens to a file which is being appended to)
+// The directories are watched instead of the files, because many editors save by replacing the file
+class file_watcher
+{
+public:
+    using callback = std::function<void(std::filesystem::path const &)>;
+    enum class trigger : uint8_t { saved, modified };
+
+private:
+    std::vector<std::filesystem::path> _files;
+    callback _on_change;
+    trigger _when;
+    std::jthread _thread;
+
+    void run(std::stop_token const & stop) const;
+
+public:
+    file_watcher(std::vector<std::filesystem::path> files, callback on_change, trigger when = trigger::saved);
+    file_watcher(file_watcher const &) = delete;
+    auto operator=(file_watcher const &) = delete;
+};
+
+} // namespace brun
+
+#endif /* WATCHER_HPP */
@@ -0,0 +1,359 @@
+/**
+ * @author      : Riccardo Brugo (brugo.riccardo@gmail.com)
+ * @file        : cache
+ * @created     : Saturday Oct 17, 2026 10:33:51 CEST
+ * @license     : MIT
+ */
+
+#include "cache.hpp"
+
+#include <array>
+#include <iterator>
+#include <fstream>
+#include <numeric>
+#include <algorithm>
+#include <type_traits>
+#include <thread>
+#include <functional>
+
+#include <unistd.h>                  // getpid
+
+#include <fmt/format.h>
+#include <fmt/ostream.h>
+
+namespace brun::cache
+{
+
+namespace
+{
+    // Layout of the image:
+    //  [header] [entry × count] [names, concatenated] [catalog × catalog_count]
+    //  [generator × generator_count] [include path size × include_count]
+    //  [catalog paths and parents, generator names and parents, include paths, concatenated]
+    // Every number is stored with the native endianness: the image is not meant to be portable,
+    //  only to be fast to read back on the machine which wrote it
+    constexpr auto magic   = std::array<char, 8>{'G', 'R', 'V', 'C', 'A', 'C', 'H', 'E'};
+    constexpr auto version = std::uint32_t{5};
+
+    struct header
+    {
+        std::array<char, 8> magic;
+        std::uint32_t version;
+        std::uint32_t entry_size;
+        std::uint64_t hash;
+        std::uint64_t count;
+        std::uint64_t names_size;
+        std::uint64_t catalog_count;
+        std::uint64_t generator_count;
+        std::uint64_t include_count;
+        std::uint64_t strings_size;
+        float trail_density;
+    };
+
+    struct entry
+    {
+        double mass;
+        std::array<double, 3> position;
+        std::array<double, 3> velocity;
+        float px_radius;
+        std::int32_t trail_size;
+        std::array<std::uint8_t, 4> color;
+        std::uint32_t name_size;
+    };
+
+    struct catalog
+    {
+        brun::catalog_ref::format kind;
+        std::array<std::uint8_t, 4> color;
+        float px_radius;
+        std::int32_t trail_size;
+        std::uint32_t path_size;
+        std::uint32_t parent_size;
+    };
+
+    struct generator
+    {
+        brun::generator_spec::shape kind;
+        std::array<std::uint8_t, 4> color;
+        float px_radius;
+        std::int32_t trail_size;
+        std::uint64_t count;
+        std::uint64_t seed;
+        std::array<double, 7> params;   // mass, inner, outer, eccentricity, inclination, thickness, scale
+        std::uint32_t name_size;
+        std::uint32_t parent_size;
+    };
+    static_assert(std::is_trivially_copyable_v<header> and std::is_trivially_copyable_v<entry>);
+    static_assert(std::is_trivially_copyable_v<catalog> and std::is_trivially_copyable_v<generator>);
+
+    auto to_entry(brun::body_record const & body) noexcept
+        -> entry
+    {
+        auto const [r, g, b, a] = body.color;
+        auto res = entry{};
+        res.mass = body.mass.count();
+        std::ranges::transform(body.position, res.position.begin(), [](auto x) { return x.count(); });
+        std::ranges::transform(body.velocity, res.velocity.begin(), [](auto x) { return x.count(); });
+        res.px_radius  = body.px_radius;
+        res.trail_size = body.trail_size;
+        res.color      = {r, g, b, a};
+        res.name_size  = static_cast<std::uint32_t>(body.name.size());
+        return res;
+    }
+
+    auto to_record(entry const & e, std::string_view const name)
+        -> brun::body_record
+    {
+        auto const [px, py, pz] = e.position;
+        auto const [vx, vy, vz] = e.velocity;
+        auto const [r, g, b, a] = e.color;
+        return brun::body_record{
+            std::string{name},
+            brun::mass{e.mass},
+            brun::position{brun::position_scalar{px}, brun::position_scalar{py}, brun::position_scalar{pz}},
+            brun::velocity{brun::velocity_scalar{vx}, brun::velocity_scalar{vy}, brun::velocity_scalar{vz}},
+            SDLpp::color{r, g, b, a},
+            e.px_radius,
+            e.trail_size
+        };
+    }
+
+    auto to_catalog(brun::catalog_ref const & ref)
+        -> catalog
+    {
+        auto const [r, g, b, a] = ref.defaults.color;
+        auto res = catalog{};
+        res.kind       = ref.kind;
+        res.color      = {r, g, b, a};
+        res.px_radius  = ref.defaults.px_radius;
+        res.trail_size = ref.defaults.trail_size;
+        res.path_size   = static_cast<std::uint32_t>(ref.path.native().size());
+        res.parent_size = static_cast<std::uint32_t>(ref.parent.size());
+        return res;
+    }
+
+    auto to_catalog_ref(catalog const & c, std::string_view const path, std::string_view const parent)
+        -> brun::catalog_ref
+    {
+        auto const [r, g, b, a] = c.color;
+        return brun::catalog_ref{
+            std::filesystem::path{path}, c.kind,
+            brun::body_defaults{SDLpp::color{r, g, b, a}, c.px_radius, c.trail_size},
+            std::string{parent}
+        };
+    }
+
+    auto to_generator(brun::generator_spec const & spec)
+        -> generator
+    {
+        auto const [r, g, b, a] = spec.defaults.color;
+        auto res = generator{};
+        res.kind        = spec.kind;
+        res.color       = {r, g, b, a};
+        res.px_radius   = spec.defaults.px_radius;
+        res.trail_size  = spec.defaults.trail_size;
+        res.count       = spec.count;
+        res.seed        = spec.seed;
+        res.params      = {spec.mass, spec.inner, spec.outer, spec.eccentricity, spec.inclination,
+                           spec.thickness, spec.scale};
+        res.name_size   = static_cast<std::uint32_t>(spec.name.size());
+        res.parent_size = static_cast<std::uint32_t>(spec.parent.size());
+        return res;
+    }
+
+    auto to_generator_spec(generator const & g, std::string_view const name, std::string_view const parent)
+        -> brun::generator_spec
+    {
+        auto const [r, gr, b, a] = g.color;
+        auto const [mass, inner, outer, eccentricity, inclination, thickness, scale] = g.params;
+        return brun::generator_spec{
+            g.kind, std::string{name}, std::string{parent}, g.count, g.seed,
+            mass, inner, outer, eccentricity, inclination, thickness, scale,
+            brun::body_defaults{SDLpp::color{r, gr, b, a}, g.px_radius, g.trail_size}
+        };
+    }
+
+    template <typename T>
+    auto read_array(std::istream & in, std::size_t const count)
+        -> std::vector<T>
+    {
+        auto res = std::vector<T>(count);
+        in.read(reinterpret_cast<char *>(res.data()), static_cast<std::streamsize>(count * sizeof(T)));
+        return res;
+    }
+} // namespace
+
+// FNV-1a, 64 bit
+auto content_hash(std::string_view const content) noexcept
+    -> std::uint64_t
+{
+    return std::accumulate(content.begin(), content.end(), std::uint64_t{0xcbf29ce484222325},
+        [](std::uint64_t hash, char const ch) {
+            return (hash ^ static_cast<unsigned char>(ch)) * std::uint64_t{0x100000001b3};
+        }
+    );
+}
+
+auto path_for(std::filesystem::path const & source)
+    -> std::filesystem::path
+{
+    auto res = source;
+    res += ".cache";
+    return res;
+}
+
+auto load(std::filesystem::path const & cache_path, std::uint64_t const hash)
+    -> std::optional<brun::scenario>
+{
+    auto file = std::ifstream{cache_path, std::ios::binary};
+    if (not file.is_open()) {
+        return std::nullopt;
+    }
+
+    auto head = header{};
+    file.read(reinterpret_cast<char *>(&head), sizeof(head));
+    if (not file or head.magic != magic or head.version != version or head.entry_size != sizeof(entry)) {
+        return std::nullopt;
+    }
+    if (head.hash != hash) {
+        return std::nullopt;
+    }
+
+    auto const entries  = read_array<entry>(file, head.count);
+    auto const names    = read_array<char>(file, head.names_size);
+    auto const catalogs   = read_array<catalog>(file, head.catalog_count);
+    auto const generators = read_array<generator>(file, head.generator_count);
+    auto const includes   = read_array<std::uint32_t>(file, head.include_count);
+    auto const strings    = read_array<char>(file, head.strings_size);
+    if (not file) {
+        fmt::print(stderr, "Warning - the scenario cache {} is truncated, ignoring it\n", cache_path);
+        return std::nullopt;
+    }
+
+    auto res = brun::scenario{};
+    res.trail_density = head.trail_density;
+    res.bodies.reserve(entries.size());
+    auto offset = std::size_t{0};
+    for (auto const & e : entries) {
+        if (offset + e.name_size > names.size()) {
+            fmt::print(stderr, "Warning - the scenario cache {} is corrupted, ignoring it\n", cache_path);
+            return std::nullopt;
+        }
+        res.bodies.push_back(to_record(e, std::string_view{names.data() + offset, e.name_size}));
+        offset += e.name_size;
+    }
+    offset = 0;
+    for (auto const & c : catalogs) {
+        if (offset + c.path_size + c.parent_size > strings.size()) {
+            fmt::print(stderr, "Warning - the scenario cache {} is corrupted, ignoring it\n", cache_path);
+            return std::nullopt;
+        }
+        auto const path   = std::string_view{strings.data() + offset, c.path_size};
+        auto const parent = std::string_view{strings.data() + offset + c.path_size, c.parent_size};
+        res.catalogs.push_back(to_catalog_ref(c, path, parent));
+        offset += c.path_size + c.parent_size;
+    }
+    for (auto const & g : generators) {
+        if (offset + g.name_size + g.parent_size > strings.size()) {
+            fmt::print(stderr, "Warning - the scenario cache {} is corrupted, ignoring it\n", cache_path);
+            return std::nullopt;
+        }
+        auto const name   = std::string_view{strings.data() + offset, g.name_size};
+        auto const parent = std::string_view{strings.data() + offset + g.name_size, g.parent_size};
+        res.generators.push_back(to_generator_spec(g, name, parent));
+        offset += g.name_size + g.parent_size;
+    }
+    for (auto const size : includes) {
+        if (offset + size > strings.size()) {
+            fmt::print(stderr, "Warning - the scenario cache {} is corrupted, ignoring it\n", cache_path);
+            return std::nullopt;
+        }
+        res.includes.emplace_back(std::string_view{strings.data() + offset, size});
+        offset += size;
+    }
+    fmt::print("Loaded {} objects from cache {}\n", res.bodies.size(), cache_path);
+    return res;
+}
+
+auto save(std::filesystem::path const & cache_path, std::uint64_t const hash, brun::scenario const & data)
+    -> bool
+{
+    auto entries = std::vector<entry>{};
+    entries.reserve(data.bodies.size());
+    std::ranges::transform(data.bodies, std::back_inserter(entries), to_entry);
+
+    auto names = std::string{};
+    for (auto const & body : data.bodies) {
+        names += body.name;
+    }
+
+    auto catalogs = std::vector<catalog>{};
+    std::ranges::transform(data.catalogs, std::back_inserter(catalogs), to_catalog);
+    auto generators = std::vector<generator>{};
+    std::ranges::transform(data.generators, std::back_inserter(generators), to_generator);
+    auto strings = std::string{};
+    for (auto const & ref : data.catalogs) {
+        strings += ref.path.native();
+        strings += ref.parent;
+    }
+    for (auto const & spec : data.generators) {
+        strings += spec.name;
+        strings += spec.parent;
+    }
+    auto includes = std::vector<std::uint32_t>{};
+    for (auto const & path : data.includes) {
+        includes.push_back(static_cast<std::uint32_t>(path.native().size()));
+        strings += path.native();
+    }
+
+    auto head = header{};
+    head.magic         = magic;
+    head.version       = version;
+    head.entry_size    = sizeof(entry);
+    head.hash          = hash;
+    head.count         = entries.size();
+    head.names_size    = names.size();
+    head.catalog_count   = catalogs.size();
+    head.generator_count = generators.size();
+    head.include_count   = includes.size();
+    head.strings_size    = strings.size();
+    head.trail_density = data.trail_density;
+
+    // Write on a temporary file, then move it: a crash in the middle never leaves a half-written image
+    // The temporary file belongs to this thread of this process, so that concurrent loads of the same file
+    //  never write on each other's
+    auto tmp_path = cache_path;
+    tmp_path += fmt::format(".{}.{:x}.tmp", ::getpid(), std::hash<std::thread::id>{}(std::this_thread::get_id()));
+    auto error = std::error_code{};
+    {
+        auto file = std::ofstream{tmp_path, std::ios::binary | std::ios::trunc};
+        if (not file.is_open()) {
+            return false;
+        }
+        file.write(reinterpret_cast<char const *>(&head), sizeof(head));
+        file.write(reinterpret_cast<char const *>(entries.data()),
+                   static_cast<std::streamsize>(entries.size() * sizeof(entry)));
+        file.write(names.data(), static_cast<std::streamsize>(names.size()));
+        file.write(reinterpret_cast<char const *>(catalogs.data()),
+                   static_cast<std::streamsize>(catalogs.size() * sizeof(catalog)));
+        file.write(reinterpret_cast<char const *>(generators.data()),
+                   static_cast<std::streamsize>(generators.size() * sizeof(generator)));
+        file.write(reinterpret_cast<char const *>(includes.data()),
+                   static_cast<std::streamsize>(includes.size() * sizeof(std::uint32_t)));
+        file.write(strings.data(), static_cast<std::streamsize>(strings.size()));
+        if (not file) {
+            file.close();
+            std::filesystem::remove(tmp_path, error);
+            return false;
+        }
+    }
+    std::filesystem::rename(tmp_path, cache_path, error);
+    if (error) {
+        std::filesystem::remove(tmp_path, error);
+        return false;
+    }
+    return true;
+}
+
+} // namespace brun::cache
+
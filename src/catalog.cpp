@@ -0,0 +1,416 @@
+/**
+ * @author      : Riccardo Brugo (brugo.riccardo@gmail.com)
+ * @file        : catalog
+ * @created     : Saturday Oct 17, 2026 12:07:40 CEST
+ * @license     : MIT
+ */
+
+#include "catalog.hpp"
+
+#include <array>
+#include <thread>
+#include <ranges>
+#include <cstring>
+#include <numeric>
+#include <charconv>
+#include <algorithm>
+#include <execution>                 // for parallelism    (std::execution::par)
+
+#include <fcntl.h>                   // open
+#include <unistd.h>                  // close
+#include <sys/mman.h>                // mmap, munmap
+#include <sys/stat.h>                // fstat
+
+#include <fmt/format.h>
+#include <fmt/ostream.h>
+
+namespace brun
+{
+
+namespace
+{
+    // A read-only memory mapping of a whole file
+    class mapped_file
+    {
+        void const * _data = MAP_FAILED;
+        std::size_t _size = 0;
+
+    public:
+        explicit mapped_file(std::filesystem::path const & path)
+        {
+            auto const fd = ::open(path.c_str(), O_RDONLY);
+            if (fd < 0) {
+                return;
+            }
+            struct stat info;
+            if (::fstat(fd, &info) == 0 and info.st_size > 0) {
+                _size = static_cast<std::size_t>(info.st_size);
+                _data = ::mmap(nullptr, _size, PROT_READ, MAP_PRIVATE, fd, 0);
+                if (_data != MAP_FAILED) {
+                    ::madvise(const_cast<void *>(_data), _size, MADV_SEQUENTIAL);
+                }
+            }
+            ::close(fd);
+        }
+        mapped_file(mapped_file const &) = delete;
+        auto operator=(mapped_file const &) = delete;
+        ~mapped_file() {
+            if (_data != MAP_FAILED) {
+                ::munmap(const_cast<void *>(_data), _size);
+            }
+        }
+
+        explicit operator bool() const noexcept { return _data != MAP_FAILED; }
+        auto view() const noexcept { return std::string_view{static_cast<char const *>(_data), _size}; }
+    };
+
+    constexpr auto binary_magic = std::array<char, 8>{'G', 'R', 'V', 'B', 'O', 'D', 'Y', '1'};
+
+    struct binary_header
+    {
+        std::array<char, 8> magic;
+        std::uint64_t count;
+    };
+
+    struct binary_body
+    {
+        std::array<char, 24> name;
+        double mass;
+        std::array<double, 3> position;
+        std::array<double, 3> velocity;
+        std::uint32_t color;
+        float px_radius;
+    };
+    static_assert(sizeof(binary_header) == 16 and sizeof(binary_body) == 88);
+
+    // How many chunks the file is split into: more than the threads, so that they stay busy
+    auto chunk_count(std::size_t const size, std::size_t const min_chunk_size)
+        -> std::size_t
+    {
+        auto const threads = std::max(std::thread::hardware_concurrency(), 1u) * 4ul;
+        return std::clamp(size / min_chunk_size, 1ul, threads);
+    }
+
+    // The indices of the chunks, to be used with the parallel algorithms
+    auto chunk_indices(std::size_t const n)
+        -> std::vector<std::size_t>
+    {
+        auto res = std::vector<std::size_t>(n);
+        std::iota(res.begin(), res.end(), 0ul);
+        return res;
+    }
+
+    auto trim(std::string_view str) noexcept
+        -> std::string_view
+    {
+        constexpr auto blanks = std::string_view{" \t\r"};
+        auto const first = str.find_first_not_of(blanks);
+        if (first == std::string_view::npos) {
+            return {};
+        }
+        return str.substr(first, str.find_last_not_of(blanks) - first + 1);
+    }
+
+    // Removes the first comma-separated field from `line` and returns it
+    auto next_field(std::string_view & line) noexcept
+        -> std::string_view
+    {
+        auto const comma = line.find(',');
+        auto const field = trim(line.substr(0, comma));
+        line = comma == std::string_view::npos ? std::string_view{} : line.substr(comma + 1);
+        return field;
+    }
+
+    template <typename T>
+    auto to_number(std::string_view const field, int const base = 10) noexcept
+        -> std::optional<T>
+    {
+        auto value = T{};
+        auto const end = field.data() + field.size();
+        auto result = std::from_chars_result{};
+        if constexpr (std::is_floating_point_v<T>) {
+            result = std::from_chars(field.data(), end, value);
+        } else {
+            result = std::from_chars(field.data(), end, value, base);
+        }
+        if (result.ec != std::errc{} or result.ptr != end) {
+            return std::nullopt;
+        }
+        return value;
+    }
+
+    auto to_color(std::string_view const field) noexcept
+        -> std::optional<SDLpp::color>
+    {
+        auto const value = field.starts_with("0x") or field.starts_with("0X") ? to_number<uint32_t>(field.substr(2), 16)
+                         : field.starts_with('#')                           ? to_number<uint32_t>(field.substr(1), 16)
+                         :                                                    to_number<uint32_t>(field)
+                         ;
+        if (not value.has_value()) {
+            return std::nullopt;
+        }
+        return SDLpp::color{
+            uint8_t((*value & 0xFF0000) >> 16), uint8_t((*value & 0x00FF00) >> 8), uint8_t(*value & 0x0000FF)
+        };
+    }
+
+    // The fields of a line of a CSV catalog: a name, seven numbers, then the optional color and radius
+    struct csv_line
+    {
+        std::string_view name;
+        std::array<double, 7> numbers;
+        SDLpp::color color;
+        brun::px_radius px_radius;
+    };
+
+    auto split_line(std::string_view line, brun::body_defaults const & defaults)
+        -> std::optional<csv_line>
+    {
+        auto res = csv_line{next_field(line), {}, defaults.color, defaults.px_radius};
+        for (auto & number : res.numbers) {
+            auto const value = to_number<double>(next_field(line));
+            if (not value.has_value()) {
+                return std::nullopt;
+            }
+            number = *value;
+        }
+        if (auto const color = next_field(line); not color.empty()) {
+            auto const value = to_color(color);
+            if (not value.has_value()) {
+                return std::nullopt;
+            }
+            res.color = *value;
+        }
+        if (auto const radius = next_field(line); not radius.empty()) {
+            auto const value = to_number<float>(radius);
+            if (not value.has_value() or *value < 0) {
+                return std::nullopt;
+            }
+            res.px_radius = *value;
+        }
+        return res;
+    }
+
+    // A line of an orbital elements catalog: name, mass, a, e, i, Ω, ω, M (, color (, px_radius))
+    // The state of the body is computed later, together with the rest of the catalog
+    auto parse_orbit_line(std::string_view const line, brun::body_defaults const & defaults)
+        -> std::optional<std::pair<brun::body_record, brun::orbital_elements>>
+    {
+        auto const fields = split_line(line, defaults);
+        if (not fields.has_value()) {
+            return std::nullopt;
+        }
+        auto const [mass, a, e, i, node, peri, mean_anomaly] = fields->numbers;
+        auto const elements = brun::orbital_elements{a, e, i, node, peri, mean_anomaly};
+        if (brun::check_elements(elements).has_value()) {
+            return std::nullopt;
+        }
+        auto body = brun::body_record{};
+        body.name       = std::string{fields->name};
+        body.mass       = brun::mass{mass};
+        body.color      = fields->color;
+        body.px_radius  = fields->px_radius;
+        body.trail_size = defaults.trail_size;
+        return std::pair{std::move(body), elements};
+    }
+
+    // The result of the parsing of a chunk; `error` is the offset of the first malformed line, if any
+    // Orbital elements are there only for catalogs of elements, one for each body
+    struct parsed_chunk
+    {
+        std::vector<brun::body_record> bodies;
+        std::vector<brun::orbital_elements> elements;
+        std::optional<std::size_t> error;
+    };
+
+    auto parse_csv_chunk(
+        std::string_view const chunk, bool const first_chunk,
+        brun::body_defaults const & defaults, bool const with_elements
+    )
+        -> parsed_chunk
+    {
+        auto res = parsed_chunk{};
+        res.bodies.reserve(chunk.size() / 64);
+        auto offset = std::size_t{0};
+        while (offset < chunk.size()) {
+            auto const end  = std::min(chunk.find('\n', offset), chunk.size());
+            auto const line = trim(chunk.substr(offset, end - offset));
+            auto const line_offset = offset;
+            offset = end + 1;
+            if (line.empty() or line.starts_with('#')) {
+                continue;
+            }
+            if (with_elements) {
+                if (auto orbit = parse_orbit_line(line, defaults); orbit.has_value()) {
+                    res.bodies.push_back(std::move(orbit->first));
+                    res.elements.push_back(orbit->second);
+                    continue;
+                }
+            } else if (auto body = parse_body_line(line, defaults); body.has_value()) {
+                res.bodies.push_back(std::move(*body));
+                continue;
+            }
+            if (not (first_chunk and line_offset == 0 and line.starts_with("name"))) {  // skip the header
+                res.error = line_offset;
+                break;
+            }
+        }
+        return res;
+    }
+
+    auto import_csv(std::string_view const text, brun::body_defaults const & defaults, bool const with_elements)
+        -> parsed_chunk
+    {
+        // Split the file in chunks which end at the end of a line
+        auto const n = chunk_count(text.size(), 1ul << 20);
+        auto bounds = std::vector<std::size_t>{0};
+        for (auto i = 1ul; i < n; ++i) {
+            auto const end = text.find('\n', std::max(bounds.back(), text.size() * i / n));
+            bounds.push_back(end == std::string_view::npos ? text.size() : end + 1);
+        }
+        bounds.push_back(text.size());
+
+        auto chunks = std::vector<parsed_chunk>(n);
+        auto const indices = chunk_indices(n);
+        std::for_each(std::execution::par, indices.begin(), indices.end(), [&](auto const i) {
+            auto const chunk = text.substr(bounds[i], bounds[i + 1] - bounds[i]);
+            chunks[i] = parse_csv_chunk(chunk, i == 0, defaults, with_elements);
+        });
+
+        auto total = std::size_t{0};
+        for (auto i = 0ul; i < n; ++i) {
+            if (chunks[i].error.has_value()) {
+                auto const position = bounds[i] + *chunks[i].error;
+                auto const line = text.substr(position, text.find('\n', position) - position);
+                fmt::print(stderr, "Error - malformed line in catalog: \"{}\"\n", line);
+                throw brun::load_error{9};
+            }
+            total += chunks[i].bodies.size();
+        }
+
+        auto res = std::move(chunks.front());
+        res.bodies.reserve(total);
+        res.elements.reserve(with_elements ? total : 0);
+        for (auto & chunk : chunks | std::views::drop(1)) {
+            std::ranges::move(chunk.bodies, std::back_inserter(res.bodies));
+            std::ranges::copy(chunk.elements, std::back_inserter(res.elements));
+        }
+        return res;
+    }
+
+    auto import_binary(std::string_view const data, brun::body_defaults const & defaults)
+        -> std::optional<std::vector<brun::body_record>>
+    {
+        auto header = binary_header{};
+        if (data.size() < sizeof(header)) {
+            return std::nullopt;
+        }
+        std::memcpy(&header, data.data(), sizeof(header));
+        if (header.magic != binary_magic or (data.size() - sizeof(header)) / sizeof(binary_body) < header.count) {
+            return std::nullopt;
+        }
+
+        auto res = std::vector<brun::body_record>(header.count);
+        auto const records = data.substr(sizeof(header));
+        auto const n = chunk_count(header.count, 1ul << 14);
+        auto const indices = chunk_indices(n);
+        std::for_each(std::execution::par, indices.begin(), indices.end(), [&](auto const chunk) {
+            auto const first = header.count * chunk / n;
+            auto const last  = header.count * (chunk + 1) / n;
+            for (auto i = first; i < last; ++i) {
+                auto body = binary_body{};
+                std::memcpy(&body, records.data() + i * sizeof(body), sizeof(body));  // records may be unaligned
+                auto const [px, py, pz] = body.position;
+                auto const [vx, vy, vz] = body.velocity;
+                auto & dest = res[i];
+                dest.name       = std::string{body.name.data(), strnlen(body.name.data(), body.name.size())};
+                dest.mass       = brun::mass{body.mass};
+                dest.position   = brun::position{brun::position_scalar{px}, brun::position_scalar{py}, brun::position_scalar{pz}};
+                dest.velocity   = brun::velocity{brun::velocity_scalar{vx}, brun::velocity_scalar{vy}, brun::velocity_scalar{vz}};
+                dest.color      = (body.color & 0xFF000000) == 0 ? defaults.color : SDLpp::color{
+                    uint8_t((body.color & 0xFF0000) >> 16), uint8_t((body.color & 0x00FF00) >> 8),
+                    uint8_t(body.color & 0x0000FF), uint8_t(body.color >> 24)
+                };
+                dest.px_radius  = body.px_radius < 0 ? defaults.px_radius : body.px_radius;
+                dest.trail_size = defaults.trail_size;
+            }
+        });
+        return res;
+    }
+} // namespace
+
+auto parse_body_line(std::string_view const line, brun::body_defaults const & defaults)
+    -> std::optional<brun::body_record>
+{
+    auto const fields = split_line(line, defaults);
+    if (not fields.has_value()) {
+        return std::nullopt;
+    }
+    auto const [mass, x, y, z, vx, vy, vz] = fields->numbers;
+    return brun::body_record{
+        std::string{fields->name},
+        brun::mass{mass},
+        brun::position{brun::position_scalar{x}, brun::position_scalar{y}, brun::position_scalar{z}},
+        brun::velocity{brun::velocity_scalar{vx}, brun::velocity_scalar{vy}, brun::velocity_scalar{vz}},
+        fields->color,
+        fields->px_radius,
+        defaults.trail_size
+    };
+}
+
+auto make_catalog_ref(std::string_view const path, std::string_view const format, brun::body_defaults const & defaults)
+    -> brun::catalog_ref
+{
+    auto res = brun::catalog_ref{std::filesystem::path{path}, brun::catalog_ref::format::binary, defaults, {}};
+    if (format == "csv" or (format.empty() and res.path.extension() == ".csv")) {
+        res.kind = brun::catalog_ref::format::csv;
+    } else if (format == "elements") {
+        res.kind = brun::catalog_ref::format::elements;
+    } else if (not format.empty() and format != "binary") {
+        fmt::print(stderr, "Error - invalid format \"{}\" for catalog {} (csv, elements and binary are supported)\n",
+                   format, path);
+        throw brun::load_error{9};
+    }
+    return res;
+}
+
+auto import_catalog(brun::catalog_ref const & catalog, brun::parent_lookup const & find_parent)
+    -> std::vector<brun::body_record>
+{
+    auto const file = mapped_file{catalog.path};
+    if (not file) {
+        fmt::print(stderr, "Error - can't open catalog {}\n", catalog.path);
+        throw brun::load_error{2};
+    }
+
+    auto bodies = std::vector<brun::body_record>{};
+    switch (catalog.kind) {
+    case brun::catalog_ref::format::csv:
+        bodies = import_csv(file.view(), catalog.defaults, false).bodies;
+        break;
+    case brun::catalog_ref::format::binary:
+        if (auto binary = import_binary(file.view(), catalog.defaults); binary.has_value()) {
+            bodies = std::move(*binary);
+        } else {
+            fmt::print(stderr, "Error - {} is not a valid binary catalog\n", catalog.path);
+            throw brun::load_error{9};
+        }
+        break;
+    case brun::catalog_ref::format::elements: {
+        auto const parent = find_parent(catalog.parent);
+        if (not parent.has_value()) {
+            fmt::print(stderr, "Error - can't find \"{}\", parent of catalog {}\n", catalog.parent, catalog.path);
+            throw brun::load_error{10};
+        }
+        auto orbits = import_csv(file.view(), catalog.defaults, true);
+        brun::place_on_orbits(orbits.bodies, orbits.elements, *parent);
+        bodies = std::move(orbits.bodies);
+        break;
+    }
+    }
+    fmt::print("Imported {} objects from catalog {}\n", bodies.size(), catalog.path);
+    return bodies;
+}
+
+} // namespace brun
+
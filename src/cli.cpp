@@ -8,6 +8,8 @@
 #include "cli.hpp"
 #include "simulation_params.hpp"
 
+#include <charconv>
+
 auto brun::parse_cli(int argc, char const * argv[])
     -> tl::expected<simulation_params, std::string>
 {
@@ -16,6 +18,12 @@ auto brun::parse_cli(int argc, char const * argv[])
     int fps = 60;
     double view_radius = 1.1 * std::sqrt(2) * 149.6;//11403.3;
     std::string filename;
+    bool watch = false;
+    std::string inject;
+    double trail_tolerance = 0.;
+    std::size_t trail_budget = 0;
+    auto record = brun::record_params{};
+    std::string record_size;
 
     auto cli = lyra::help(show_help)
              | lyra::arg(filename, "dataset path")("path to the dataset")
@@ -25,6 +33,24 @@ auto brun::parse_cli(int argc, char const * argv[])
                         ("Graphics framerate -- 0 to disable graphics")
              | lyra::opt(view_radius, "view radius")["-r"]["--radius"]
                         ("Default view radius")
+             | lyra::opt(watch)["-w"]["--watch"]
+                        ("Apply the changes of the dataset file to the running simulation")
+             | lyra::opt(inject, "pipe or file")["-i"]["--inject"]
+                        ("Add to the simulation the bodies written in a named pipe or appended to a file")
+             | lyra::opt(trail_tolerance, "tolerance")["--trail-tolerance"]
+                        ("Keep a trail point only where the path bends more than this, relative to the length of its "
+                         "pieces (e.g. 0.01) -- 0 to keep every point")
+             | lyra::opt(trail_budget, "points")["--trail-budget"]
+                        ("Maximum number of points of a trail -- 0 for no limit")
+             | lyra::opt(record.path, "file")["--record"]
+                        ("Render without a window to a Y4M video (\"out.y4m\") or to PNG files (\"frame_{:05}.png\"), "
+                         "a frame every 1/fps seconds of simulation")
+             | lyra::opt(record.frames, "frames")["--record-frames"]
+                        ("Number of frames to record -- 0 to record until the simulation ends")
+             | lyra::opt(record_size, "WxH")["--record-size"]
+                        ("Size of the recorded frames (default 1280x720)")
+             | lyra::opt(record.density)["--record-density"]
+                        ("Draw the test particles as a map of their density in the recorded frames")
              ;
     auto const result = cli.parse({argc, argv});
     if (not result) {
@@ -34,12 +60,30 @@ auto brun::parse_cli(int argc, char const * argv[])
         fmt::print("{}\n", cli);
         return tl::expected<simulation_params, std::string>{tl::unexpect, ""};
     }
+    if (not record_size.empty()) {
+        auto const x = record_size.find('x');
+        auto const parsed = x != std::string::npos
+                        and std::from_chars(record_size.data(), record_size.data() + x, record.width).ptr == record_size.data() + x
+                        and std::from_chars(record_size.data() + x + 1, record_size.data() + record_size.size(), record.height).ptr
+                            == record_size.data() + record_size.size();
+        if (not parsed or record.width <= 0 or record.height <= 0) {
+            return tl::expected<simulation_params, std::string>{tl::unexpect, "the size of the frames must be given as WxH"};
+        }
+    }
+    if (not record.path.empty() and fps <= 0) {
+        return tl::expected<simulation_params, std::string>{tl::unexpect, "recording needs a positive framerate"};
+    }
     auto params = simulation_params{
         units::physical::si::time<units::physical::si::day>{days_per_second},
         units::physical::si::frequency<units::physical::si::hertz>{fps},
         5.f,
         brun::position_scalar{view_radius},
-        std::move(filename)
+        std::move(filename),
+        watch,
+        std::move(inject),
+        trail_tolerance,
+        trail_budget,
+        std::move(record)
     };
     return params;//return tl::expected<simulation_params, std::string>
 }
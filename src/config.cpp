@@ -5,17 +5,20 @@
  * @license     : MIT
  */
 
+#include <map>
+#include <atomic>
 #include <fstream>
-#include <variant>
+#include <functional>
+#include <iterator>
 #include <random>
+#include <numeric>
 #include <optional>
 #include <algorithm>
+#include <exception>
+#include <execution>                 // for parallelism    (std::execution::par)
 #include <filesystem>
 
 #include <toml.hpp>
-#ifndef GRAVITY_NO_JSON
-#   include <nlohmann/json.hpp>
-#endif // GRAVITY_NO_JSON
 
 #include <tl/expected.hpp>
 // #include <range/v3/action/transform.hpp>
@@ -27,49 +30,42 @@
 // using std::experimental::dynamic_extent;
 // } // namespace STD_LA :: detail
 #include "common.hpp"
+#include "cache.hpp"
+#include "scenario.hpp"
+#include "json_loader.hpp"
+#include "catalog.hpp"
+#include "kepler.hpp"
+#include "generators.hpp"
 
 namespace brun
 {
 namespace detail
 {
-    // Loads from file a JSON or a TOML table
-    auto load_data(std::filesystem::path const & data_path)
-#ifndef GRAVITY_NO_JSON
-        -> std::variant<nlohmann::json, toml::table>
-#else
-        -> std::variant<toml::table>
-#endif
+    // Reads the whole content of a scenario file
+    auto read_file(std::filesystem::path const & data_path)
+        -> std::string
     {
         if (not std::filesystem::exists(data_path)) {
             fmt::print(stderr, "Error - can't find file {}\n", data_path);
-            std::exit(1);
+            throw brun::load_error{1};
         }
-        auto file = std::ifstream{data_path};
+        auto file = std::ifstream{data_path, std::ios::binary};
         if (not file.is_open()) {
             fmt::print(stderr, "Error - can't open file {}\n", data_path);
-            std::exit(2);
+            throw brun::load_error{2};
         }
+        return std::string{std::istreambuf_iterator<char>{file}, std::istreambuf_iterator<char>{}};
+    }
 
+    // Lowercase extension of a scenario file
+    auto extension(std::filesystem::path const & data_path)
+        -> std::string
+    {
         constexpr auto tolower = [](unsigned char ch) noexcept { return std::tolower(ch); };
         // auto const ext = data_path.extension().string() | ranges::actions::transform(tolower);
         auto ext = data_path.extension().string();
         std::ranges::transform(ext, ext.begin(), tolower);
-        if (ext == ".json") {
-#ifndef GRAVITY_NO_JSON
-            auto json = nlohmann::json{};
-            file >> json;
-            return json;
-#else
-            fmt::print(stderr, "Error - json support is not enabled\n");
-            std::exit(3);
-#endif
-        } else if (ext == ".toml") {
-            return toml::parse(file);
-        } else {
-            fmt::print(stderr, "Error - invalid file format (json and toml files are supported)\n");
-            std::exit(3);
-        }
-
+        return ext;
     }
 
     // Builds a vector from a TOML table
@@ -132,34 +128,6 @@ namespace detail
         return expected{tl::unexpect, parse_error};
     }
 
-#ifndef GRAVITY_NO_JSON
-    // Build a registry from a JSON table
-    auto build_registry(nlohmann::json const & json) //FIXME //TODO incomplete
-        -> std::pair<entt::registry, float>
-    {
-        using brun::literals::operator""_Gm;
-        using brun::literals::operator""_kmps;
-        using brun::literals::operator""_Yg;
-        auto registry = entt::registry{};
-        for (auto const & data : json) {
-            auto const entity = registry.create();
-            auto const position = brun::position{0._Gm, data["distance_from_sun [e6 km]"].get<double>() * 1._Gm, 0._Gm};
-            auto const velocity = brun::velocity{data["orbital_velocity [km/s]"].get<double>() * 1._kmps, 0._kmps, 0._kmps};
-            auto const mass     = brun::mass{data["mass [Yg]"].get<double>() * 1._Yg};
-            auto const name     = data["name"].get<std::string>();
-            auto const color    = data.value("color", 0xFFFF00);
-            registry.emplace<brun::tag>(entity, name);
-            registry.emplace<brun::position>(entity, position);
-            registry.emplace<brun::velocity>(entity, velocity);
-            registry.emplace<brun::mass>(entity, mass);
-            registry.emplace<SDLpp::color>(entity, SDLpp::color{
-                uint8_t((color & 0xFF0000) >> 16), uint8_t((color & 0x00FF00) >> 8), uint8_t(color & 0x0000FF)
-            }); //this or without default?
-        }
-        return {std::move(registry), 5.f};
-    }
-#endif // GRAVITY_NO_JSON
-
     // Given a table an attribute and an optional default value, returns the content of the table if it is
     //  present and match the requested type, or the default value if the table has not an entry named after attr;
     //  if no default value is given or if the entry has a value with the wrong type, an error is returned
@@ -191,66 +159,122 @@ namespace detail
     }
 
 
+    // Computes the state of an object from its orbital elements
+    // The orbit is around the object it is a satellite of or, for top level objects, around the object named
+    //  by the "parent" attribute: it is looked for among the objects of the file, then with `find_parent`
+    auto extract_orbit(
+        std::string const & name, brun::mass const mass, toml::table const & elements_tbl,
+        std::optional<std::string> const & parent_name, std::optional<brun::orbital_parent> const & parent,
+        std::vector<brun::body_record> const & bodies, brun::parent_lookup const & find_parent
+    )
+        -> std::pair<brun::position, brun::velocity>
+    {
+        auto const a    = expect<double>(elements_tbl, "a");
+        auto const e    = expect<double>(elements_tbl, "e", 0.);
+        auto const i    = expect<double>(elements_tbl, "i", 0.);
+        auto const node = expect<double>(elements_tbl, "node", 0.);
+        auto const peri = expect<double>(elements_tbl, "peri", 0.);
+        auto const M    = expect<double>(elements_tbl, "M", 0.);
+        if (not a.has_value()) {
+            fmt::print(stderr, "{} in the orbital elements of {}\n", a.error(), name);
+            throw brun::load_error{10};
+        }
+        auto const elements = brun::orbital_elements{*a, *e, *i, *node, *peri, *M};
+        if (auto const error = brun::check_elements(elements); error.has_value()) {
+            fmt::print(stderr, "Error - invalid orbital elements for {}: {}\n", name, *error);
+            throw brun::load_error{10};
+        }
+
+        auto center = parent;
+        if (parent_name.has_value()) {
+            auto const found = std::find_if(bodies.rbegin(), bodies.rend(), [&parent_name](auto const & body) {
+                return body.name == *parent_name;
+            });
+            center = found != bodies.rend() ? brun::orbital_parent{found->position, found->velocity, found->mass}
+                                            : find_parent(*parent_name);
+            if (not center.has_value()) {
+                fmt::print(stderr, "Error - can't find \"{}\", parent of {}\n", *parent_name, name);
+                throw brun::load_error{10};
+            }
+        }
+        if (not center.has_value()) {
+            fmt::print(stderr, "Error - {} has orbital elements but no parent\n", name);
+            throw brun::load_error{10};
+        }
+        return brun::orbit_state(elements, mass, *center);
+    }
+
     void extract_object(
-        entt::registry & registry, toml::table const & table,
+        std::vector<brun::body_record> & bodies, toml::table const & table, brun::parent_lookup const & find_parent,
         tl::expected<int32_t, std::string> const & default_trail_length,
         tl::expected<float, std::string> const & default_trail_density,
         tl::expected<int32_t, std::string> const & default_color,
         tl::expected<float, std::string> const & default_px_radius,
-        brun::position const base_position = brun::position{} * 0.,
-        brun::velocity const base_velocity = brun::velocity{} * 0.
+        std::optional<brun::orbital_parent> const & parent = std::nullopt
     )
     {
         auto const name      = table["name"].as_string()->get();
         auto const mass      = expect<double>(table, "mass");
         auto const pos_node  = table["distance"];
         auto const vel_node  = table["orbital_velocity"]; // TODO: not needed for all objects
+        auto const elements  = table["elements"].as_table();
         auto const trail_len = expect<int32_t>(table, "motion_trail_length",  *default_trail_length);
         auto const trail_den = expect<int32_t>(table, "motion_trail_density", *default_trail_density);
         auto const color     = expect<int32_t>(table, "color", *default_color);
         auto const px_radius = expect<float>(table, "px_radius", *default_px_radius);
 
-        auto const position = build_vector<brun::position>(pos_node);
-        auto const velocity = build_vector<brun::velocity>(vel_node);
-
         if (not mass.has_value()) {
             fmt::print(stderr, "{}\n", mass.error());
-            std::exit(5);
-        }
-        if (not position.has_value()) {
-            fmt::print(stderr, position.error(), "position");
-            fmt::print("\n");
-            std::exit(6);
-        }
-        if (not velocity.has_value()) {
-            fmt::print(stderr, velocity.error(), "velocity");
-            fmt::print("\n");
-            std::exit(7);
+            throw brun::load_error{5};
         }
         if (not px_radius.has_value()) {
             fmt::print(stderr, "{}\n", px_radius.error());
-            std::exit(7);
+            throw brun::load_error{7};
         }
         if (*px_radius < 0) {
             fmt::print(stderr, "Error - cannot use a negative value for {} px_radius\n", name);
-            std::exit(8);
+            throw brun::load_error{8};
         }
 
-        // Create a new entity inside the registry and register its attributes
+        // The state is given either by orbital elements or by a position and a velocity relative to the parent
+        auto state = std::pair<brun::position, brun::velocity>{};
+        if (elements != nullptr) {
+            state = extract_orbit(
+                name, *mass * 1._Yg, *elements, table["parent"].value<std::string>(), parent, bodies, find_parent
+            );
+        } else {
+            auto const position = build_vector<brun::position>(pos_node);
+            auto const velocity = build_vector<brun::velocity>(vel_node);
+            if (not position.has_value()) {
+                fmt::print(stderr, position.error(), "position");
+                fmt::print("\n");
+                throw brun::load_error{6};
+            }
+            if (not velocity.has_value()) {
+                fmt::print(stderr, velocity.error(), "velocity");
+                fmt::print("\n");
+                throw brun::load_error{7};
+            }
+            auto const base_position = parent.has_value() ? parent->position : brun::position{} * 0.;
+            auto const base_velocity = parent.has_value() ? parent->velocity : brun::velocity{} * 0.;
+            state = std::pair{*position + base_position, *velocity + base_velocity};
+        }
+        auto const [position, velocity] = state;
+
+        // Register the object and its attributes; entities are created later, all at once
         fmt::print("Registered object \"{}\"\n", name);
-        auto const entity = registry.create();
-        registry.emplace<brun::tag>(entity, name);
-        registry.emplace<brun::position>(entity, position.value() + base_position);
-        registry.emplace<brun::velocity>(entity, velocity.value() + base_velocity);
-        registry.emplace<brun::mass>(entity, *mass * 1._Yg);
-        registry.emplace<SDLpp::color>(entity, SDLpp::color{
-            uint8_t((*color & 0xFF0000) >> 16), uint8_t((*color & 0x00FF00) >> 8), uint8_t(*color & 0x0000FF)
+        auto const n = trail_len.value(), d = trail_den.value();
+        bodies.push_back(brun::body_record{
+            name,
+            *mass * 1._Yg,
+            position,
+            velocity,
+            SDLpp::color{
+                uint8_t((*color & 0xFF0000) >> 16), uint8_t((*color & 0x00FF00) >> 8), uint8_t(*color & 0x0000FF)
+            },
+            *px_radius,
+            std::max(n * d, 0)
         });
-        registry.emplace<brun::px_radius>(entity, *px_radius);
-        if (auto const n = trail_len.value(), d = trail_den.value(); d * n > 0) {
-            auto & tail = registry.emplace<brun::trail>(entity);
-            tail.resize(n * d, *position + base_position);
-        }
 
         // Planets
         if (auto const satellites_tbl = table["satellites"].as_array(); satellites_tbl) {
@@ -259,20 +283,116 @@ namespace detail
             for (auto const & subnode : satellites) {
                 auto const & sub_table = *subnode.as_table();
                 extract_object(
-                    registry, sub_table,
+                    bodies, sub_table, find_parent,
                     default_trail_length, default_trail_density, default_color, default_px_radius,
-                    *position + base_position, *velocity + base_velocity
+                    brun::orbital_parent{position, velocity, *mass * 1._Yg}
                 );
             }
         }
     }
 
-    // Build a registry from a TOML table
-    auto build_registry(toml::table const & toml)
-        -> std::pair<entt::registry, float>
+    // Reads the attributes shared by all the bodies of a catalog or of a generator
+    auto extract_defaults(
+        toml::table const & table, std::string_view const what,
+        tl::expected<int32_t, std::string> const & default_trail_length,
+        tl::expected<float, std::string> const & default_trail_density,
+        tl::expected<int32_t, std::string> const & default_color,
+        tl::expected<float, std::string> const & default_px_radius
+    )
+        -> brun::body_defaults
+    {
+        auto const trail_len = expect<int32_t>(table, "motion_trail_length",  *default_trail_length);
+        auto const trail_den = expect<int32_t>(table, "motion_trail_density", *default_trail_density);
+        auto const color     = expect<int32_t>(table, "color", *default_color);
+        auto const px_radius = expect<float>(table, "px_radius", *default_px_radius);
+        if (*px_radius < 0) {
+            fmt::print(stderr, "Error - cannot use a negative value for the px_radius of {}\n", what);
+            throw brun::load_error{8};
+        }
+        return brun::body_defaults{
+            SDLpp::color{
+                uint8_t((*color & 0xFF0000) >> 16), uint8_t((*color & 0x00FF00) >> 8), uint8_t(*color & 0x0000FF)
+            },
+            *px_radius,
+            std::max(*trail_len * *trail_den, 0)
+        };
+    }
+
+    // Reads the reference to an external catalog of bodies
+    auto extract_catalog(
+        toml::table const & table,
+        tl::expected<int32_t, std::string> const & default_trail_length,
+        tl::expected<float, std::string> const & default_trail_density,
+        tl::expected<int32_t, std::string> const & default_color,
+        tl::expected<float, std::string> const & default_px_radius
+    )
+        -> brun::catalog_ref
+    {
+        auto const path      = table["path"].value<std::string>();
+        auto const format    = table["format"].value<std::string>();
+        auto const parent    = table["parent"].value<std::string>();
+        if (not path.has_value()) {
+            fmt::print(stderr, "Error - every catalog needs a \"path\"\n");
+            throw brun::load_error{9};
+        }
+        auto const defaults = extract_defaults(table, fmt::format("catalog {}", *path),
+                                               default_trail_length, default_trail_density,
+                                               default_color, default_px_radius);
+        auto catalog = brun::make_catalog_ref(*path, format.value_or(""), defaults);
+        if (catalog.kind == brun::catalog_ref::format::elements) {
+            if (not parent.has_value()) {
+                fmt::print(stderr, "Error - the catalog of orbital elements {} needs a \"parent\"\n", *path);
+                throw brun::load_error{10};
+            }
+            catalog.parent = *parent;
+        }
+        return catalog;
+    }
+
+    // Reads a [[belt]], [[ring]] or [[cluster]] block
+    auto extract_generator(
+        std::string_view const section, toml::table const & table,
+        tl::expected<int32_t, std::string> const & default_trail_length,
+        tl::expected<float, std::string> const & default_trail_density,
+        tl::expected<int32_t, std::string> const & default_color,
+        tl::expected<float, std::string> const & default_px_radius
+    )
+        -> brun::generator_spec
     {
-        using brun::literals::operator""_Yg;
-        auto registry = entt::registry{};
+        auto const defaults = extract_defaults(table, fmt::format("a [[{}]] block", section),
+                                               default_trail_length, default_trail_density,
+                                               default_color, default_px_radius);
+        return brun::make_generator(section,
+            [&table](auto const key) { return table[key].template value<double>(); },
+            [&table](auto const key) { return table[key].template value<std::string>(); },
+            defaults
+        );
+    }
+
+    // Other scenarios, whose bodies are loaded before the ones of a file
+    auto extract_includes(toml::table const & toml)
+        -> std::vector<std::filesystem::path>
+    {
+        auto includes = std::vector<std::filesystem::path>{};
+        if (auto const include_arr = toml["include"].as_array(); include_arr) {
+            for (auto const & node : *include_arr) {
+                auto const path = node.value<std::string>();
+                if (not path.has_value()) {
+                    fmt::print(stderr, "Error - \"include\" must be a list of paths\n");
+                    throw brun::load_error{12};
+                }
+                includes.emplace_back(*path);
+            }
+        }
+        return includes;
+    }
+
+    // Build a scenario from a TOML table; the parents which are not in the file are looked for with
+    //  `find_parent`
+    auto build_scenario(toml::table const & toml, brun::parent_lookup const & find_parent)
+        -> brun::scenario
+    {
+        auto bodies = std::vector<brun::body_record>{};
 
         // Get configuration
         auto const default_trail_length  = expect<int32_t>(toml["config"], "motion_trail_length", 0);
@@ -281,36 +401,291 @@ namespace detail
         auto const default_px_radius     = expect<float>(toml["config"], "default_px_radius", 5.);
         if (not default_color.has_value()) {
             fmt::print(stderr, "{}\n", default_color.error());
-            std::exit(7);
+            throw brun::load_error{7};
         }
         if (not default_px_radius.has_value()) {
             fmt::print(stderr, "{}\n", default_px_radius.error());
-            std::exit(7);
+            throw brun::load_error{7};
         }
         if (*default_px_radius < 0) {
             fmt::print(stderr, "Error - cannot use a negative value for the default px_radius\n");
-            std::exit(8);
+            throw brun::load_error{8};
         }
 
         // Build planets, stars and other objects listed in the config file
-        auto const & planets = *toml["object"].as_array();
-        for (auto const & node : planets) {
-            auto const & table = *node.as_table();
-            extract_object(registry, table,
-                           default_trail_length, default_trail_density,
-                           default_color, default_px_radius);
-        }
-        return std::pair{std::move(registry), default_trail_density.value()};
+        if (auto const planets = toml["object"].as_array(); planets) {
+            for (auto const & node : *planets) {
+                auto const & table = *node.as_table();
+                extract_object(bodies, table, find_parent,
+                               default_trail_length, default_trail_density,
+                               default_color, default_px_radius);
+            }
+        }
+
+        // Big lists of bodies are stored in external catalogs, which are imported after the objects
+        auto catalogs = std::vector<brun::catalog_ref>{};
+        if (auto const catalog_tbl = toml["catalog"].as_array(); catalog_tbl) {
+            for (auto const & node : *catalog_tbl) {
+                catalogs.push_back(extract_catalog(*node.as_table(),
+                                                   default_trail_length, default_trail_density,
+                                                   default_color, default_px_radius));
+            }
+        }
+
+        // Populations of bodies drawn from random distributions, created after everything else
+        auto generators = std::vector<brun::generator_spec>{};
+        for (auto const section : {"belt", "ring", "cluster"}) {
+            if (auto const generator_tbl = toml[section].as_array(); generator_tbl) {
+                for (auto const & node : *generator_tbl) {
+                    generators.push_back(extract_generator(section, *node.as_table(),
+                                                           default_trail_length, default_trail_density,
+                                                           default_color, default_px_radius));
+                }
+            }
+        }
+        return brun::scenario{
+            std::move(bodies), std::move(catalogs), std::move(generators), extract_includes(toml),
+            default_trail_density.value()
+        };
+    }
+
+    // Looks for the last body with the given name in a list
+    auto find_record(std::vector<brun::body_record> const & bodies, std::string_view const name)
+        -> std::optional<brun::orbital_parent>
+    {
+        auto const found = std::find_if(bodies.rbegin(), bodies.rend(), [name](auto const & body) {
+            return body.name == name;
+        });
+        if (found == bodies.rend()) {
+            return std::nullopt;
+        }
+        return brun::orbital_parent{found->position, found->velocity, found->mass};
+    }
+
+    // A batch of bodies, with the file they come from and the load of the file which read them: a file
+    //  included by two others (e.g. the common one of a diamond) is read by two loads
+    struct body_batch
+    {
+        std::filesystem::path file;     // canonical
+        std::uint64_t load;
+        std::vector<brun::body_record> bodies;
+    };
+    using batch_sink = std::function<void(body_batch &&)>;
+
+    // Looks for the last body with the given name in a list of batches
+    auto find_record(std::vector<body_batch> const & batches, std::string_view const name)
+        -> std::optional<brun::orbital_parent>
+    {
+        for (auto batch = batches.rbegin(); batch != batches.rend(); ++batch) {
+            if (auto found = find_record(batch->bodies, name); found.has_value()) {
+                return found;
+            }
+        }
+        return std::nullopt;
+    }
+
+    auto load_scenario(
+        std::filesystem::path const & data, batch_sink const & sink, brun::parent_lookup const & find_parent,
+        std::vector<std::filesystem::path> * files, std::vector<std::filesystem::path> chain
+    ) -> float;
+
+    // Thrown by the lookup of an included file which is loaded concurrently, when a parent is not among the
+    //  bodies of the file itself
+    struct deferred_parent {};
+
+    // Loads the included scenarios concurrently; their bodies are handed to `sink` in the order of the
+    //  list, so the entities are always created in the same order
+    // The concurrent loads see only their own bodies: `find_parent` may read the registry, which is not safe
+    //  from many threads. A file which needs a parent from outside is loaded again afterwards, in order, when
+    //  it can use also the bodies loaded before the include and the ones of the files before it in the list
+    void load_includes(
+        std::vector<std::filesystem::path> const & includes,
+        batch_sink const & sink, brun::parent_lookup const & find_parent,
+        std::vector<std::filesystem::path> * files, std::vector<std::filesystem::path> const & chain
+    )
+    {
+        struct included
+        {
+            std::vector<body_batch> batches;
+            std::vector<std::filesystem::path> files;
+            std::exception_ptr error;
+        };
+        auto loaded = std::vector<included>(includes.size());
+        auto const load = [&includes, &chain](included & file, std::size_t const i, auto const & outside) {
+            auto & batches = file.batches;
+            load_scenario(includes[i],
+                [&batches](body_batch && batch) { batches.push_back(std::move(batch)); },
+                [&batches, &outside](auto const name) {
+                    auto const found = find_record(batches, name);
+                    return found.has_value() ? found : outside(name);
+                },
+                &file.files, chain
+            );
+        };
+
+        auto indices = std::vector<std::size_t>(includes.size());
+        std::iota(indices.begin(), indices.end(), 0ul);
+        std::for_each(std::execution::par, indices.begin(), indices.end(), [&](auto const i) {
+            try {
+                load(loaded[i], i, [](auto) -> std::optional<brun::orbital_parent> { throw deferred_parent{}; });
+            } catch (...) {
+                loaded[i].error = std::current_exception();   // exceptions can't leave a parallel algorithm
+            }
+        });
+
+        for (auto i = 0ul; i < loaded.size(); ++i) {
+            auto & file = loaded[i];
+            if (file.error) {
+                try {
+                    std::rethrow_exception(file.error);
+                } catch (deferred_parent const &) {
+                    file.batches.clear();
+                    file.files.clear();
+                    load(file, i, find_parent);
+                }
+            }
+            for (auto & batch : file.batches) {
+                sink(std::move(batch));
+            }
+            if (files != nullptr) {
+                std::ranges::move(file.files, std::back_inserter(*files));
+            }
+        }
+    }
+
+    // Loads data from the file passed as argument
+    // Parsing a big TOML scenario is slow, so the parsed bodies are stored in a compiled image next to the
+    //  file: as long as the content of the file does not change, the image is loaded in its place. Catalogs
+    //  are not part of the image: they are fast to import, and they can change without touching the
+    //  scenario. Generators are stored as their parameters, and expanded every time.
+    // JSON scenarios are streamed instead, and their bodies enter the registry while the file is being read
+    auto load_scenario(
+        std::filesystem::path const & data, batch_sink const & sink, brun::parent_lookup const & find_parent,
+        std::vector<std::filesystem::path> * files, std::vector<std::filesystem::path> chain
+    )
+        -> float
+    {
+        // `chain` holds the files which include this one
+        auto const canonical = std::filesystem::weakly_canonical(data);
+        if (std::ranges::find(chain, canonical) != chain.end()) {
+            fmt::print(stderr, "Error - {} includes itself\n", data);
+            throw brun::load_error{12};
+        }
+        chain.push_back(canonical);
+        if (files != nullptr) {
+            files->push_back(data);
+        }
+        static auto loads = std::atomic<std::uint64_t>{0};
+        auto const load = loads.fetch_add(1, std::memory_order::relaxed);
+        auto const own = [&sink, &canonical, load](std::vector<brun::body_record> && bodies) {
+            sink(body_batch{canonical, load, std::move(bodies)});
+        };
+
+        auto const ext = extension(data);
+        if (ext == ".json") {
+#ifndef GRAVITY_NO_JSON
+            return brun::stream_json(data, own, find_parent, [&](auto const & includes) {
+                load_includes(includes, sink, find_parent, files, chain);
+            });
+#else
+            fmt::print(stderr, "Error - json support is not enabled\n");
+            throw brun::load_error{3};
+#endif
+        } else if (ext != ".toml") {
+            fmt::print(stderr, "Error - invalid file format (json and toml files are supported)\n");
+            throw brun::load_error{3};
+        }
+
+        auto const content    = read_file(data);
+        auto const hash       = cache::content_hash(content);
+        auto const cache_path = cache::path_for(data);
+
+        // The objects of the file may orbit the ones of the included files: a file is built only after them
+        auto scenario = cache::load(cache_path, hash);
+        auto const table = scenario.has_value() ? std::optional<toml::table>{}
+                                                : std::optional<toml::table>{toml::parse(content, data.string())};
+
+        // Included files, catalogs and generators are relative to the scenario
+        auto includes = scenario.has_value() ? scenario->includes : extract_includes(*table);
+        for (auto & path : includes) {
+            path = data.parent_path() / path;
+        }
+        load_includes(includes, sink, find_parent, files, chain);
+
+        if (not scenario.has_value()) {
+            // A file whose objects orbit a body from outside depends on more than its content: it isn't cached
+            auto outside = false;
+            scenario = build_scenario(*table, [&outside, &find_parent](auto const name) {
+                outside = true;
+                return find_parent(name);
+            });
+            if (not outside and not cache::save(cache_path, hash, *scenario)) {
+                fmt::print(stderr, "Warning - can't write the scenario cache {}\n", cache_path);
+            }
+        }
+
+        own(std::move(scenario->bodies));
+        for (auto catalog : scenario->catalogs) {
+            catalog.path = data.parent_path() / catalog.path;
+            own(brun::import_catalog(catalog, find_parent));
+        }
+        for (auto const & generator : scenario->generators) {
+            own(brun::expand_generator(generator, find_parent));
+        }
+        return scenario->trail_density;
     }
 } // namespace detail
 
-// Loads data from the file passed as argument and build the registry
-auto load_data(std::filesystem::path const & data)
-    -> std::pair<entt::registry, float>
+auto load_scenario(
+    std::filesystem::path const & data, brun::body_sink const & sink, brun::parent_lookup const & find_parent,
+    std::vector<std::filesystem::path> * files
+)
+    -> float
 {
-    return std::visit([](auto const & table) { return detail::build_registry(table); }, detail::load_data(data));
+    // A file included more than once gives its bodies only the first time: the batches of the other loads of
+    //  it are dropped. Batches come in the order of the scenario, so the first load is always the same one
+    auto first_loads = std::map<std::filesystem::path, std::uint64_t>{};
+    return detail::load_scenario(data,
+        [&sink, &first_loads](detail::body_batch && batch) {
+            auto const [first, _] = first_loads.try_emplace(batch.file, batch.load);
+            if (first->second == batch.load) {
+                sink(std::move(batch.bodies));
+            }
+        },
+        find_parent, files, {}
+    );
 }
 
-} // namespace brun
+auto load_data(std::filesystem::path const & data, std::vector<std::filesystem::path> * files)
+    -> std::pair<entt::registry, float>
+{
+    auto registry = entt::registry{};
+    try {
+        auto const trail_density = load_scenario(data,
+            [&registry](auto && bodies) { brun::insert_bodies(registry, std::move(bodies)); },
+            [&registry](auto const name) { return brun::find_orbital_parent(registry, name); },
+            files
+        );
+        return std::pair{std::move(registry), trail_density};
+    } catch (brun::load_error const & error) {
+        std::exit(error.status);
+    }
+}
 
+auto read_bodies(std::filesystem::path const & data, std::vector<std::filesystem::path> * files)
+    -> std::optional<std::vector<brun::body_record>>
+{
+    auto res = std::vector<brun::body_record>{};
+    try {
+        load_scenario(data,
+            [&res](auto && bodies) { std::ranges::move(bodies, std::back_inserter(res)); },
+            [&res](auto const name) { return detail::find_record(res, name); },
+            files
+        );
+    } catch (brun::load_error const &) {
+        return std::nullopt;
+    }
+    return res;
+}
 
+} // namespace brun
@@ -0,0 +1,153 @@
+/**
+ * @author      : Riccardo Brugo (brugo.riccardo@gmail.com)
+ * @file        : culling
+ * @created     : Saturday Oct 17, 2026 19:24:10 CEST
+ * @license     : MIT
+ */
+
+#include "culling.hpp"
+#include "interpolation.hpp"
+
+#include <span>
+#include <cmath>
+#include <numeric>
+#include <utility>
+#include <algorithm>
+#include <execution>                 // for parallelism    (std::execution::par)
+
+namespace brun
+{
+
+namespace
+{
+    // From km/s to Gm/day
+    constexpr auto kmps_to_Gm_per_day = 86400. / 1e6;
+
+    // Spreads the lowest 21 bits of `x` so that there are two zeroes between each of them
+    constexpr auto spread(std::uint64_t x) noexcept
+        -> std::uint64_t
+    {
+        x &= 0x1f'ffff;
+        x = (x | x << 32) & 0x1f'0000'0000'ffff;
+        x = (x | x << 16) & 0x1f'0000'ff00'00ff;
+        x = (x | x << 8)  & 0x100f'00f0'0f00'f00f;
+        x = (x | x << 4)  & 0x10c3'0c30'c30c'30c3;
+        x = (x | x << 2)  & 0x1249'2492'4924'9249;
+        return x;
+    }
+} // namespace
+
+void body_tree::sort(entt::registry const & registry)
+{
+    auto const positions = registry.view<brun::position const>();
+    auto bounds = brun::bounding_box{};
+    for (auto const & p : std::span{positions.raw(), positions.size()}) {
+        bounds.expand(p);
+    }
+
+    // Every coordinate becomes a 21 bit integer, and the three of them are interleaved
+    auto keyed = std::vector<std::pair<std::uint64_t, entt::entity>>(positions.size());
+    auto indices = std::vector<std::size_t>(positions.size());
+    std::iota(indices.begin(), indices.end(), 0ul);
+    std::for_each(std::execution::par_unseq, indices.begin(), indices.end(), [&](auto const i) {
+        auto const & p = positions.raw()[i];
+        auto key = std::uint64_t{0};
+        for (auto k = 0ul; k < 3; ++k) {
+            auto const extent = bounds.max[k] - bounds.min[k];
+            auto const unit = extent > 0 ? (p[k].count() - bounds.min[k]) / extent : 0.;
+            key |= spread(static_cast<std::uint64_t>(unit * 0x1f'ffff)) << k;
+        }
+        keyed[i] = std::pair{key, positions.data()[i]};
+    });
+    std::sort(std::execution::par_unseq, keyed.begin(), keyed.end(), [](auto const & a, auto const & b) {
+        return a.first < b.first;
+    });
+
+    _bodies.resize(keyed.size());
+    std::ranges::transform(keyed, _bodies.begin(), [](auto const & k) { return k.second; });
+    _leaves = (_bodies.size() + leaf_size - 1) / leaf_size;
+    _nodes.assign(2 * _leaves, brun::bounding_box{});
+    _fits = 0;
+}
+
+void body_tree::fit(entt::registry const & registry, double const travel)
+{
+    auto leaves = std::vector<std::size_t>(_leaves);
+    auto speeds = std::vector<double>(_leaves, 0.);
+    std::iota(leaves.begin(), leaves.end(), 0ul);
+    std::for_each(std::execution::par, leaves.begin(), leaves.end(), [&](auto const leaf) {
+        auto & box = _nodes[_leaves + leaf];
+        box = brun::bounding_box{};
+        auto const last = std::min((leaf + 1) * leaf_size, _bodies.size());
+        for (auto i = leaf * leaf_size; i < last; ++i) {
+            box.expand(registry.get<brun::position>(_bodies[i]));
+            // The bodies are drawn from where they were at the previous step
+            if (auto const * previous = registry.try_get<brun::last_position>(_bodies[i]); previous != nullptr) {
+                box.expand(previous->value);
+            }
+            if (auto const * v = registry.try_get<brun::velocity>(_bodies[i]); v != nullptr) {
+                speeds[leaf] = std::max(speeds[leaf], brun::norm(*v).count());
+            }
+        }
+    });
+    for (auto i = _leaves - 1; i > 0; --i) {
+        _nodes[i] = _nodes[2 * i];
+        _nodes[i].merge(_nodes[2 * i + 1]);
+    }
+    // The bodies added since the last step have not been seen by the simulation yet
+    _speed = std::ranges::max(speeds) * kmps_to_Gm_per_day;
+    _travel = travel;
+    ++_fits;
+}
+
+void body_tree::update(
+    entt::registry const & registry, std::uint64_t const revision, double const travel, double const top_speed,
+    double const radius
+)
+{
+    auto const count = registry.view<brun::position const>().size();
+    if (count == 0) {
+        _bodies.clear();
+        _nodes.clear();
+        _leaves = 0;
+        return;
+    }
+    if (revision != _revision or count != _bodies.size() or _fits >= fits_per_sort) {
+        _revision = revision;
+        sort(registry);
+        fit(registry, travel);
+    } else if (travel - _travel > radius) {
+        fit(registry, travel);
+    }
+    _moved = travel - _travel;
+    _speed = std::max(_speed, top_speed);
+}
+
+void body_tree::query(
+    brun::position const & center, double const radius, double const lead, std::vector<entt::entity> & out
+) const
+{
+    if (_leaves == 0) {
+        return;
+    }
+    auto const margin = _moved + _speed * lead;
+    auto stack = std::vector<std::size_t>{1};
+    while (not stack.empty()) {
+        auto const node = stack.back();
+        stack.pop_back();
+        if (not _nodes[node].touches(center, radius, margin)) {
+            continue;
+        }
+        if (node < _leaves) {
+            stack.push_back(2 * node);
+            stack.push_back(2 * node + 1);
+            continue;
+        }
+        auto const leaf = node - _leaves;
+        auto const last = std::min((leaf + 1) * leaf_size, _bodies.size());
+        out.insert(out.end(), _bodies.begin() + static_cast<std::ptrdiff_t>(leaf * leaf_size),
+                              _bodies.begin() + static_cast<std::ptrdiff_t>(last));
+    }
+}
+
+} // namespace brun
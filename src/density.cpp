@@ -0,0 +1,85 @@
+/**
+ * @author      : Riccardo Brugo (brugo.riccardo@gmail.com)
+ * @file        : density
+ * @created     : Saturday Oct 17, 2026 19:54:02 CEST
+ * @license     : MIT
+ */
+
+#include "density.hpp"
+
+#include <cmath>
+#include <thread>
+#include <numeric>
+#include <algorithm>
+#include <execution>                 // for parallelism    (std::execution::par)
+
+namespace brun
+{
+
+namespace
+{
+    // Fewer points than this are binned by a single thread
+    constexpr auto points_per_tile = std::size_t{1 << 16};
+    constexpr auto rows_per_block = 16;
+
+    void bin(
+        std::span<float const> const x, std::span<float const> const y, int const width, int const height,
+        float * grid
+    ) noexcept
+    {
+        for (auto i = 0ul; i < x.size(); ++i) {
+            auto const px = static_cast<int>(std::floor(x[i]));
+            auto const py = static_cast<int>(std::floor(y[i]));
+            if (px >= 0 and px < width and py >= 0 and py < height) {
+                grid[static_cast<std::size_t>(py) * static_cast<std::size_t>(width) + static_cast<std::size_t>(px)] += 1.f;
+            }
+        }
+    }
+} // namespace
+
+auto density_map::splat(
+    std::span<float const> const x, std::span<float const> const y, int const width, int const height,
+    std::vector<float> & out
+)
+    -> float
+{
+    auto const pixels = static_cast<std::size_t>(width) * static_cast<std::size_t>(height);
+    out.assign(pixels, 0.f);
+    auto const threads = std::max(std::thread::hardware_concurrency(), 1u);
+    auto const tiles = std::clamp<std::size_t>(x.size() / points_per_tile, 1, threads);
+    if (tiles == 1) {
+        bin(x, y, width, height, out.data());
+        return out.empty() ? 0.f : std::ranges::max(out);
+    }
+
+    _tiles.resize(tiles);
+    auto indices = std::vector<std::size_t>(tiles);
+    std::iota(indices.begin(), indices.end(), 0ul);
+    std::for_each(std::execution::par, indices.begin(), indices.end(), [&](auto const t) {
+        auto const first = x.size() * t / tiles;
+        auto const last  = x.size() * (t + 1) / tiles;
+        _tiles[t].assign(pixels, 0.f);
+        bin(x.subspan(first, last - first), y.subspan(first, last - first), width, height, _tiles[t].data());
+    });
+
+    // The grids are summed by blocks of rows, and every block finds its own peak
+    auto blocks = std::vector<int>((height + rows_per_block - 1) / rows_per_block);
+    auto peaks  = std::vector<float>(blocks.size(), 0.f);
+    std::iota(blocks.begin(), blocks.end(), 0);
+    std::for_each(std::execution::par, blocks.begin(), blocks.end(), [&](auto const block) {
+        auto const first = static_cast<std::size_t>(block * rows_per_block) * static_cast<std::size_t>(width);
+        auto const last  = std::min(first + static_cast<std::size_t>(rows_per_block * width), pixels);
+        auto & peak = peaks[static_cast<std::size_t>(block)];
+        for (auto i = first; i < last; ++i) {
+            auto sum = 0.f;
+            for (auto const & tile : _tiles) {
+                sum += tile[i];
+            }
+            out[i] = sum;
+            peak = std::max(peak, sum);
+        }
+    });
+    return peaks.empty() ? 0.f : std::ranges::max(peaks);
+}
+
+} // namespace brun
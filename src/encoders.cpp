@@ -0,0 +1,270 @@
+/**
+ * @author      : Riccardo Brugo (brugo.riccardo@gmail.com)
+ * @file        : encoders
+ * @created     : Saturday Oct 17, 2026 23:48:22 CEST
+ * @license     : MIT
+ */
+
+#include "encoders.hpp"
+
+#include <span>
+#include <array>
+#include <cmath>
+#include <string_view>
+#include <algorithm>
+
+#include <fmt/format.h>
+
+namespace brun
+{
+
+namespace
+{
+    // Bits are packed from the least significant one, as deflate wants
+    class bit_writer
+    {
+        std::vector<std::uint8_t> & _out;
+        std::uint32_t _bits = 0;
+        int _count = 0;
+
+    public:
+        explicit bit_writer(std::vector<std::uint8_t> & out) : _out{out} {}
+
+        void put(std::uint32_t const value, int const n)
+        {
+            _bits |= value << _count;
+            _count += n;
+            for (; _count >= 8; _count -= 8) {
+                _out.push_back(static_cast<std::uint8_t>(_bits & 0xff));
+                _bits >>= 8;
+            }
+        }
+
+        // Huffman codes are packed from their most significant bit
+        void put_code(std::uint32_t const code, int const n)
+        {
+            auto reversed = std::uint32_t{0};
+            for (auto i = 0; i < n; ++i) {
+                reversed |= (code >> i & 1) << (n - 1 - i);
+            }
+            put(reversed, n);
+        }
+
+        void flush()
+        {
+            if (_count > 0) {
+                _out.push_back(static_cast<std::uint8_t>(_bits & 0xff));
+            }
+            _bits = 0;
+            _count = 0;
+        }
+    };
+
+    constexpr auto length_base = std::array<std::uint16_t, 29>{
+        3, 4, 5, 6, 7, 8, 9, 10, 11, 13, 15, 17, 19, 23, 27, 31, 35, 43, 51, 59, 67, 83, 99, 115, 131, 163, 195, 227, 258
+    };
+    constexpr auto length_extra = std::array<std::uint8_t, 29>{
+        0, 0, 0, 0, 0, 0, 0, 0, 1, 1, 1, 1, 2, 2, 2, 2, 3, 3, 3, 3, 4, 4, 4, 4, 5, 5, 5, 5, 0
+    };
+    constexpr auto distance_base = std::array<std::uint16_t, 30>{
+        1, 2, 3, 4, 5, 7, 9, 13, 17, 25, 33, 49, 65, 97, 129, 193, 257, 385, 513, 769, 1025, 1537, 2049, 3073,
+        4097, 6145, 8193, 12289, 16385, 24577
+    };
+    constexpr auto distance_extra = std::array<std::uint8_t, 30>{
+        0, 0, 0, 0, 1, 1, 2, 2, 3, 3, 4, 4, 5, 5, 6, 6, 7, 7, 8, 8, 9, 9, 10, 10, 11, 11, 12, 12, 13, 13
+    };
+    constexpr auto max_match = std::size_t{258};
+    constexpr auto max_distance = std::size_t{32768};
+
+    // The fixed literal/length code of deflate
+    void put_symbol(bit_writer & bits, std::uint32_t const symbol)
+    {
+        if (symbol < 144) {
+            bits.put_code(0x30 + symbol, 8);
+        } else if (symbol < 256) {
+            bits.put_code(0x190 + symbol - 144, 9);
+        } else if (symbol < 280) {
+            bits.put_code(symbol - 256, 7);
+        } else {
+            bits.put_code(0xc0 + symbol - 280, 8);
+        }
+    }
+
+    // The index of the last entry of `bases` not greater than `value`
+    template <std::size_t N>
+    auto bucket(std::array<std::uint16_t, N> const & bases, std::size_t const value)
+    {
+        return static_cast<std::size_t>(std::ranges::upper_bound(bases, value) - bases.begin()) - 1;
+    }
+
+    void put_match(bit_writer & bits, std::size_t const length, std::size_t const distance)
+    {
+        auto const l = bucket(length_base, length);
+        put_symbol(bits, static_cast<std::uint32_t>(257 + l));
+        bits.put(static_cast<std::uint32_t>(length - length_base[l]), length_extra[l]);
+        auto const d = bucket(distance_base, distance);
+        bits.put_code(static_cast<std::uint32_t>(d), 5);
+        bits.put(static_cast<std::uint32_t>(distance - distance_base[d]), distance_extra[d]);
+    }
+
+    // A zlib stream with a single block of fixed codes; matches are looked for only at `distances`
+    auto deflate(std::span<std::uint8_t const> const data, std::span<std::size_t const> const distances)
+        -> std::vector<std::uint8_t>
+    {
+        auto out = std::vector<std::uint8_t>{0x78, 0x01};
+        out.reserve(data.size() / 8 + 64);
+        auto bits = bit_writer{out};
+        bits.put(1, 1);     // last block
+        bits.put(1, 2);     // fixed codes
+        for (auto i = 0ul; i < data.size(); ) {
+            auto best_length = std::size_t{0}, best_distance = std::size_t{0};
+            for (auto const d : distances) {
+                if (d > i or d > max_distance) {
+                    continue;
+                }
+                auto const limit = std::min(max_match, data.size() - i);
+                auto length = std::size_t{0};
+                while (length < limit and data[i + length] == data[i + length - d]) {
+                    ++length;
+                }
+                if (length > best_length) {
+                    best_length = length;
+                    best_distance = d;
+                }
+            }
+            if (best_length >= 3) {
+                put_match(bits, best_length, best_distance);
+                i += best_length;
+            } else {
+                put_symbol(bits, data[i]);
+                ++i;
+            }
+        }
+        put_symbol(bits, 256);
+        bits.flush();
+
+        auto a = std::uint32_t{1}, b = std::uint32_t{0};
+        for (auto const byte : data) {
+            a = (a + byte) % 65521;
+            b = (b + a) % 65521;
+        }
+        auto const adler = b << 16 | a;
+        for (auto shift = 24; shift >= 0; shift -= 8) {
+            out.push_back(static_cast<std::uint8_t>(adler >> shift & 0xff));
+        }
+        return out;
+    }
+
+    auto crc32(std::span<std::uint8_t const> const data, std::uint32_t crc = 0xffffffff)
+        -> std::uint32_t
+    {
+        static auto const table = [] {
+            auto res = std::array<std::uint32_t, 256>{};
+            for (auto n = 0u; n < 256; ++n) {
+                auto c = n;
+                for (auto k = 0; k < 8; ++k) {
+                    c = (c & 1) != 0 ? 0xedb88320 ^ (c >> 1) : c >> 1;
+                }
+                res[n] = c;
+            }
+            return res;
+        }();
+        for (auto const byte : data) {
+            crc = table[(crc ^ byte) & 0xff] ^ (crc >> 8);
+        }
+        return crc;
+    }
+
+    void put_u32(std::vector<std::uint8_t> & out, std::uint32_t const value)
+    {
+        for (auto shift = 24; shift >= 0; shift -= 8) {
+            out.push_back(static_cast<std::uint8_t>(value >> shift & 0xff));
+        }
+    }
+
+    void put_chunk(std::vector<std::uint8_t> & out, std::string_view const type, std::span<std::uint8_t const> const data)
+    {
+        put_u32(out, static_cast<std::uint32_t>(data.size()));
+        auto const first = out.size();
+        out.insert(out.end(), type.begin(), type.end());
+        out.insert(out.end(), data.begin(), data.end());
+        put_u32(out, crc32(std::span{out}.subspan(first)) ^ 0xffffffff);
+    }
+} // namespace
+
+auto encode_png(brun::rgb_image const & image)
+    -> std::vector<std::uint8_t>
+{
+    // Every row starts with its filter: none
+    auto const stride = static_cast<std::size_t>(image.width) * 3;
+    auto raw = std::vector<std::uint8_t>{};
+    raw.reserve((stride + 1) * static_cast<std::size_t>(image.height));
+    for (auto y = 0ul; y < static_cast<std::size_t>(image.height); ++y) {
+        raw.push_back(0);
+        auto const row = image.pixels.begin() + static_cast<std::ptrdiff_t>(y * stride);
+        raw.insert(raw.end(), row, row + static_cast<std::ptrdiff_t>(stride));
+    }
+    auto const distances = std::array{std::size_t{3}, stride + 1};
+
+    auto out = std::vector<std::uint8_t>{0x89, 'P', 'N', 'G', '\r', '\n', 0x1a, '\n'};
+    auto header = std::vector<std::uint8_t>{};
+    put_u32(header, static_cast<std::uint32_t>(image.width));
+    put_u32(header, static_cast<std::uint32_t>(image.height));
+    header.insert(header.end(), {8, 2, 0, 0, 0});     // 8 bits, RGB, deflate, no interlace
+    put_chunk(out, "IHDR", header);
+    put_chunk(out, "IDAT", deflate(raw, distances));
+    put_chunk(out, "IEND", {});
+    return out;
+}
+
+auto y4m_header(int const width, int const height, int const fps)
+    -> std::string
+{
+    // The samples take the full range: without saying so, readers would take them for the limited one
+    return fmt::format("YUV4MPEG2 W{} H{} F{}:1 Ip A1:1 C420jpeg XCOLORRANGE=FULL\n", width, height, fps);
+}
+
+auto encode_y4m_frame(brun::rgb_image const & image)
+    -> std::vector<std::uint8_t>
+{
+    constexpr auto tag = std::string_view{"FRAME\n"};
+    auto const w = static_cast<std::size_t>(image.width), h = static_cast<std::size_t>(image.height);
+    auto const cw = (w + 1) / 2, ch = (h + 1) / 2;
+    auto out = std::vector<std::uint8_t>(tag.size() + w * h + 2 * cw * ch);
+    std::ranges::copy(tag, out.begin());
+    auto * const luma = out.data() + tag.size();
+    auto * const cb = luma + w * h;
+    auto * const cr = cb + cw * ch;
+    auto const byte = [](float const v) { return static_cast<std::uint8_t>(std::lround(std::clamp(v, 0.f, 255.f))); };
+    auto const pixel = [&image, w](std::size_t const x, std::size_t const y) {
+        auto const * p = image.pixels.data() + (y * w + x) * 3;
+        return std::array{static_cast<float>(p[0]), static_cast<float>(p[1]), static_cast<float>(p[2])};
+    };
+
+    for (auto y = 0ul; y < h; ++y) {
+        for (auto x = 0ul; x < w; ++x) {
+            auto const [r, g, b] = pixel(x, y);
+            luma[y * w + x] = byte(0.299f * r + 0.587f * g + 0.114f * b);
+        }
+    }
+    // The chroma of a block of 2×2 pixels is the one of their mean
+    for (auto y = 0ul; y < ch; ++y) {
+        for (auto x = 0ul; x < cw; ++x) {
+            auto sum = std::array{0.f, 0.f, 0.f};
+            auto n = 0.f;
+            for (auto dy = 0ul; dy < 2 and 2 * y + dy < h; ++dy) {
+                for (auto dx = 0ul; dx < 2 and 2 * x + dx < w; ++dx) {
+                    auto const p = pixel(2 * x + dx, 2 * y + dy);
+                    sum = {sum[0] + p[0], sum[1] + p[1], sum[2] + p[2]};
+                    n += 1.f;
+                }
+            }
+            auto const r = sum[0] / n, g = sum[1] / n, b = sum[2] / n;
+            cb[y * cw + x] = byte(128.f - 0.168736f * r - 0.331264f * g + 0.5f * b);
+            cr[y * cw + x] = byte(128.f + 0.5f * r - 0.418688f * g - 0.081312f * b);
+        }
+    }
+    return out;
+}
+
+} // namespace brun
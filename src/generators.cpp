@@ -0,0 +1,272 @@
+/**
+ * @author      : Riccardo Brugo (brugo.riccardo@gmail.com)
+ * @file        : generators
+ * @created     : Saturday Oct 17, 2026 14:14:20 CEST
+ * @license     : MIT
+ */
+
+#include "generators.hpp"
+#include "simulation.hpp"
+
+#include <array>
+#include <cmath>
+#include <random>
+#include <numbers>
+#include <numeric>
+#include <algorithm>
+#include <execution>                 // for parallelism    (std::execution::par)
+
+#include <fmt/format.h>
+
+namespace brun
+{
+
+namespace
+{
+    constexpr auto chunk_size = std::size_t{8192};
+    constexpr auto two_pi = 2. * std::numbers::pi;
+    constexpr auto deg = std::numbers::pi / 180.;
+    // G, from m³/(s²·kg) to Gm³/(s²·Yg)
+    constexpr auto G = brun::constants::G<>.count() * 1e21 / 1e27;
+
+    [[noreturn]] void fail(brun::generator_spec const & spec, std::string_view const what)
+    {
+        fmt::print(stderr, "Error - generator \"{}\": {}\n", spec.name, what);
+        throw brun::load_error{11};
+    }
+
+    // The random stream of a chunk depends only on the seed and on the index of the chunk
+    auto chunk_engine(std::uint64_t const seed, std::size_t const chunk)
+        -> std::mt19937_64
+    {
+        auto sequence = std::seed_seq{
+            static_cast<std::uint32_t>(seed),  static_cast<std::uint32_t>(seed >> 32),
+            static_cast<std::uint32_t>(chunk), static_cast<std::uint32_t>(chunk >> 32)
+        };
+        return std::mt19937_64{sequence};
+    }
+
+    // Calls `fill(engine, first, last)` on every chunk of [0, count), in parallel
+    template <typename Function>
+    void for_each_chunk(std::uint64_t const seed, std::size_t const count, Function const & fill)
+    {
+        auto chunks = std::vector<std::size_t>((count + chunk_size - 1) / chunk_size);
+        std::iota(chunks.begin(), chunks.end(), 0ul);
+        std::for_each(std::execution::par, chunks.begin(), chunks.end(), [&](auto const chunk) {
+            auto engine = chunk_engine(seed, chunk);
+            auto const first = chunk * chunk_size;
+            fill(engine, first, std::min(first + chunk_size, count));
+        });
+    }
+
+    // A direction drawn uniformly on the sphere
+    auto isotropic(std::mt19937_64 & engine)
+        -> std::array<double, 3>
+    {
+        auto const z   = std::uniform_real_distribution{-1., 1.}(engine);
+        auto const phi = std::uniform_real_distribution{0., two_pi}(engine);
+        auto const rho = std::sqrt(1. - z * z);
+        return {rho * std::cos(phi), rho * std::sin(phi), z};
+    }
+
+    auto make_position(std::array<double, 3> const & v, double const scale)
+    {
+        using brun::position_scalar;
+        return brun::position{position_scalar{v[0] * scale}, position_scalar{v[1] * scale}, position_scalar{v[2] * scale}};
+    }
+
+    auto make_velocity(std::array<double, 3> const & v, double const scale)
+    {
+        using brun::velocity_scalar;
+        return brun::velocity{velocity_scalar{v[0] * scale}, velocity_scalar{v[1] * scale}, velocity_scalar{v[2] * scale}};
+    }
+
+    // Belts and rings: every body gets its own orbital elements around the parent
+    void fill_orbits(
+        brun::generator_spec const & spec, std::vector<brun::body_record> & bodies, brun::orbital_parent const & parent
+    )
+    {
+        auto elements = std::vector<brun::orbital_elements>(bodies.size());
+        for_each_chunk(spec.seed, bodies.size(), [&](auto & engine, auto const first, auto const last) {
+            auto angle = std::uniform_real_distribution{0., 360.};
+            auto belt_a = std::uniform_real_distribution{spec.inner, spec.outer};
+            // Rings have the same surface density everywhere
+            auto ring_a2 = std::uniform_real_distribution{spec.inner * spec.inner, spec.outer * spec.outer};
+            auto eccentricity = std::uniform_real_distribution{0., spec.eccentricity};
+            auto inclination  = std::uniform_real_distribution{0., spec.inclination};
+            auto height = std::normal_distribution{0., spec.thickness > 0 ? spec.thickness : 1.};
+            for (auto k = first; k < last; ++k) {
+                auto & el = elements[k];
+                if (spec.kind == brun::generator_spec::shape::belt) {
+                    el.a = belt_a(engine);
+                    el.e = eccentricity(engine);
+                    el.i = inclination(engine);
+                } else {
+                    el.a = std::sqrt(ring_a2(engine));
+                    el.e = 0.;
+                    el.i = spec.thickness > 0 ? std::abs(height(engine)) / el.a / deg : 0.;
+                }
+                el.node = angle(engine);
+                el.peri = angle(engine);
+                el.mean_anomaly = angle(engine);
+            }
+        });
+        brun::place_on_orbits(bodies, elements, parent);
+    }
+
+    // Plummer sphere of radius `scale`: positions from the cumulative mass profile, speeds from the
+    //  distribution function with von Neumann rejection (Aarseth, Hénon & Wielen, 1974)
+    void fill_plummer(
+        brun::generator_spec const & spec, std::vector<brun::body_record> & bodies, brun::orbital_parent const & center
+    )
+    {
+        auto const gm = G * spec.mass * static_cast<double>(bodies.size());
+        for_each_chunk(spec.seed, bodies.size(), [&](auto & engine, auto const first, auto const last) {
+            auto uniform = std::uniform_real_distribution{0., 1.};
+            for (auto k = first; k < last; ++k) {
+                // The distribution has an infinite tail: it is cut at 20 radii
+                auto r = 0.;
+                do {
+                    r = spec.scale / std::sqrt(std::pow(uniform(engine), -2. / 3.) - 1.);
+                } while (not (r < 20. * spec.scale));
+                auto q = 0.;
+                while (true) {
+                    q = uniform(engine);
+                    if (0.1 * uniform(engine) < q * q * std::pow(1. - q * q, 3.5)) {
+                        break;
+                    }
+                }
+                auto const escape = std::sqrt(2. * gm) * std::pow(r * r + spec.scale * spec.scale, -0.25);
+                bodies[k].position = center.position + make_position(isotropic(engine), r);
+                bodies[k].velocity = center.velocity + make_velocity(isotropic(engine), q * escape * 1e6);
+            }
+        });
+    }
+
+    // Exponential disk of scale length `scale` in the x-y plane, on circular orbits around the mass
+    //  enclosed by each of them (disk and central body, taken as spherical)
+    void fill_disk(
+        brun::generator_spec const & spec, std::vector<brun::body_record> & bodies, brun::orbital_parent const & center
+    )
+    {
+        auto const disk_mass = spec.mass * static_cast<double>(bodies.size());
+        for_each_chunk(spec.seed, bodies.size(), [&](auto & engine, auto const first, auto const last) {
+            auto uniform = std::uniform_real_distribution{0., 1.};
+            auto height = std::normal_distribution{0., spec.thickness > 0 ? spec.thickness : 1.};
+            for (auto k = first; k < last; ++k) {
+                // R·exp(-R/h) is a gamma distribution: the sum of two exponential ones
+                auto const R = -spec.scale * std::log((1. - uniform(engine)) * (1. - uniform(engine)));
+                auto const phi = uniform(engine) * two_pi;
+                auto const z = spec.thickness > 0 ? height(engine) : 0.;
+                auto const x = R / spec.scale;
+                auto const enclosed = center.mass.count() + disk_mass * (1. - (1. + x) * std::exp(-x));
+                auto const speed = R > 0 ? std::sqrt(G * enclosed / R) * 1e6 : 0.;
+                auto const c = std::cos(phi), s = std::sin(phi);
+                bodies[k].position = center.position + make_position({R * c, R * s, z}, 1.);
+                bodies[k].velocity = center.velocity + make_velocity({-s, c, 0.}, speed);
+            }
+        });
+    }
+} // namespace
+
+auto make_generator(
+    std::string_view const section, number_source const & number, text_source const & text,
+    brun::body_defaults const & defaults
+)
+    -> brun::generator_spec
+{
+    using shape = brun::generator_spec::shape;
+    auto spec = brun::generator_spec{};
+    spec.name     = text("name").value_or(std::string{section});
+    spec.parent   = text("parent").value_or("");
+    spec.defaults = defaults;
+    spec.mass     = number("mass").value_or(0.);
+    spec.seed     = static_cast<std::uint64_t>(number("seed").value_or(0.));
+
+    auto const count = number("count");
+    if (not count.has_value() or *count < 1) {
+        fail(spec, "needs a positive \"count\"");
+    }
+    spec.count = static_cast<std::uint64_t>(*count);
+    if (spec.mass < 0) {
+        fail(spec, "cannot use a negative mass");
+    }
+
+    if (section == "belt" or section == "ring") {
+        spec.kind  = section == "belt" ? shape::belt : shape::ring;
+        spec.inner = number("inner").value_or(0.);
+        spec.outer = number("outer").value_or(0.);
+        spec.eccentricity = number("max_eccentricity").value_or(0.);
+        spec.inclination  = number("max_inclination").value_or(0.);
+        spec.thickness    = number("thickness").value_or(0.);
+        if (not (spec.inner > 0 and spec.inner <= spec.outer)) {
+            fail(spec, "needs 0 < inner <= outer");
+        }
+        if (not (spec.eccentricity >= 0 and spec.eccentricity < 1)) {
+            fail(spec, "the eccentricity must be in [0, 1)");
+        }
+        if (spec.inclination < 0 or spec.thickness < 0) {
+            fail(spec, "cannot use a negative inclination or thickness");
+        }
+        if (spec.parent.empty()) {
+            fail(spec, "needs a \"parent\"");
+        }
+    } else {
+        auto const profile = text("profile").value_or("plummer");
+        if (profile != "plummer" and profile != "disk") {
+            fail(spec, fmt::format("unknown profile \"{}\" (\"plummer\" or \"disk\" are supported)", profile));
+        }
+        spec.kind      = profile == "plummer" ? shape::plummer : shape::disk;
+        spec.scale     = number("scale").value_or(0.);
+        spec.thickness = number("thickness").value_or(0.);
+        if (not (spec.scale > 0)) {
+            fail(spec, "needs a positive \"scale\"");
+        }
+        if (spec.thickness < 0) {
+            fail(spec, "cannot use a negative thickness");
+        }
+    }
+    return spec;
+}
+
+auto expand_generator(brun::generator_spec const & spec, brun::parent_lookup const & find_parent)
+    -> std::vector<brun::body_record>
+{
+    auto center = brun::orbital_parent{brun::position{} * 0., brun::velocity{} * 0., brun::mass{0.}};
+    if (not spec.parent.empty()) {
+        auto const parent = find_parent(spec.parent);
+        if (not parent.has_value()) {
+            fail(spec, fmt::format("can't find the parent \"{}\"", spec.parent));
+        }
+        center = *parent;
+    }
+
+    auto bodies = std::vector<brun::body_record>(spec.count);
+    for_each_chunk(spec.seed, bodies.size(), [&](auto &, auto const first, auto const last) {
+        for (auto k = first; k < last; ++k) {
+            auto & body = bodies[k];
+            body.name       = fmt::format("{} {}", spec.name, k);
+            body.mass       = brun::mass{spec.mass};
+            body.color      = spec.defaults.color;
+            body.px_radius  = spec.defaults.px_radius;
+            body.trail_size = spec.defaults.trail_size;
+        }
+    });
+
+    switch (spec.kind) {
+    case brun::generator_spec::shape::belt:
+    case brun::generator_spec::shape::ring:
+        fill_orbits(spec, bodies, center);
+        break;
+    case brun::generator_spec::shape::plummer:
+        fill_plummer(spec, bodies, center);
+        break;
+    case brun::generator_spec::shape::disk:
+        fill_disk(spec, bodies, center);
+        break;
+    }
+    fmt::print("Generated {} bodies from \"{}\"\n", bodies.size(), spec.name);
+    return bodies;
+}
+
+} // namespace brun
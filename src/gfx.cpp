@@ -7,14 +7,30 @@
 
 #include "gfx.hpp"
 #include "common.hpp"
-
+#include "geometry.hpp"
+#include "trail.hpp"
+#include "projection.hpp"
+#include "culling.hpp"
+#include "density.hpp"
+#include "names.hpp"
+#include "interpolation.hpp"
+#include "raster.hpp"
+#include "orbits.hpp"
+#include "prediction.hpp"
+
+#include <cmath>
 #include <mutex>
+#include <tuple>
+#include <array>
+#include <chrono>
+#include <limits>
+#include <string>
 #include <numbers>
-
-#include <range/v3/view/tail.hpp>
-#include <range/v3/view/zip.hpp>
-
-#include <SDLpp/paint/shapes.hpp>
+#include <vector>
+#include <cstdint>
+#include <optional>
+#include <span>
+#include <unordered_map>
 
 #include <GL/glew.h>
 #include <imgui.h>
@@ -29,111 +45,312 @@ namespace
     template<class... Ts> struct overloaded : Ts... { using Ts::operator()...; };
     template<class... Ts> overloaded(Ts...) -> overloaded<Ts...>;
 
-    template <typename ...Components>
+    // A followed body is drawn between two states: so is the camera
     inline
-    auto ts_get(brun::context const & ctx, auto entt)
-    {
-        return std::shared_lock{ctx}, ctx.reg.get<Components...>(entt);
-    }
-
-    inline
-    auto compute_origin(brun::context const & ctx)
+    auto compute_origin(brun::context const & ctx, brun::blend const & blend)
         -> brun::position
     {
         auto const & follow = ctx.follow;
         auto const & reg = ctx.reg;
         auto lock = std::shared_lock{ctx};  // Lock the data (for safety reasons in multithreading)
+        if (auto const * target = std::get_if<brun::follow::target>(&follow); target != nullptr) {
+            return blended_position(reg, target->id, blend) + target->offset;
+        }
         return absolute_position(reg, follow);
     }
 
-    // Display every object whith a position, a color and a pixel radius
-    auto display(brun::context const & ctx, SDLpp::renderer & renderer)
-        -> std::pair<std::vector<SDLpp::paint::circle>, std::vector<SDLpp::paint::line>>
+    // What the persistent trails depend on: when it changes they are drawn again from scratch
+    struct camera_view
     {
-        auto const & registry = ctx.reg;
-        auto const [view_radius, rotation] = [&ctx]{
-            return std::shared_lock{ctx}, std::pair{ctx.view_radius, build_rotation_matrix(ctx.rotation)};
-        }();
-        auto const [_a, _b, w, h] = renderer.size(); // get width and height
-        auto const compute_displacement = [origin = compute_origin(ctx)](auto const & _1) {
-            static_assert(std::same_as<std::decay_t<decltype(origin)>, std::decay_t<decltype(_1)>>);
-            return _1 - origin;
-        };
+        brun::position_scalar view_radius;
+        brun::rotation_info rotation;
+        brun::follow_t follow;
+        int width;
+        int height;
+    };
 
-        // Rescale the vector such that the screen has "radius" 1.
-        // FIXME this way one cannot see planets in the corner, outside of the circle
-        auto const scale_coeff = 1. / view_radius * std::min(w, h) * 0.5; // px/Gm
-        auto rescale = [scale_coeff](auto const & _1) {
-            auto const tmp = scale_coeff * _1; // this is a vector of dimensionless units;
-                                               // should be ok, but fails to compile
-                                               // so i need to transform it in a vector of scalars
-            auto res = la::fs_vector<double, tmp.size()>{};
-            std::transform(begin(tmp), end(tmp), begin(res), [](auto x) { return x.count(); });
-            return res; //scale_coeff * _1;
+    auto same_view(camera_view const & a, camera_view const & b)
+        -> bool
+    {
+        auto const offset = [](brun::follow_t const & follow) {
+            return std::visit([](auto const & f) { return f.offset; }, follow);
         };
-        auto rotate  = [&rotation]  (auto const & _1) { return rotation    * _1; };
+        auto const target = [](brun::follow_t const & follow) {
+            auto const * t = std::get_if<brun::follow::target>(&follow);
+            return t != nullptr ? t->id : static_cast<entt::entity>(-1);
+        };
+        return a.view_radius == b.view_radius and a.width == b.width and a.height == b.height
+           and a.rotation.z_axis == b.rotation.z_axis and a.rotation.x_axis == b.rotation.x_axis
+           and a.follow.index() == b.follow.index() and target(a.follow) == target(b.follow)
+           and brun::norm(offset(a.follow) - offset(b.follow)).count() == 0.;
+    }
 
-        // Build a "circle" to be displayed
-        auto to_circle = [&renderer, w, h](brun::position const & pos, SDLpp::color const color, float const radius)
+    // What the bodies on the screen depend on: while it stays the same, so does the geometry of a frame
+    struct scene_epochs
+    {
+        std::uint64_t state;
+        std::uint64_t camera;
+        int width;
+        int height;
+        bool trails;
+        bool splats;
+        bool software;
+        bool orbits;
+        std::uint64_t prediction;
+
+        auto operator==(scene_epochs const &) const -> bool = default;
+    };
+
+    // Trails drawn on a canvas which is kept between frames: at every frame it fades a little, and only the
+    //  piece of trail covered since the previous frame is added to it
+    // The canvas is in screen space, so while the camera follows a moving object the trails show the paths
+    //  relative to it
+    struct persistent_trails
+    {
+        struct head
         {
-            auto const position = SDLpp::point2d(pos[0].count() + w/2, pos[1].count() + h/2);
-            return SDLpp::paint::circle{renderer, position, radius, color};
+            float x, y;
+            std::uint64_t frame;            // a head which was not seen at the previous frame is stale
         };
 
+        bool enabled = false;
+        float persistence = 3.f;            // seconds for a trail to fade to 1%
+        std::optional<camera_view> view;    // the view the canvas was drawn with
+        std::unordered_map<entt::entity, head> heads;   // where every trail ends on the canvas
+        std::uint64_t frame = 0;
+    };
+
+    // Bodies in a bound orbit drawn as the conic of their orbit, instead of with their trail: the orbits are
+    //  computed again for every new state, and the trails of the bodies drawn this way are parked
+    struct orbit_mode
+    {
+        bool enabled = false;
+        std::uint64_t epoch = std::numeric_limits<std::uint64_t>::max();    // the state the orbits are of
+        std::vector<brun::osculating_orbit> orbits;
+        std::vector<entt::entity> bound;    // the bodies of `orbits`, sorted
+        std::vector<entt::entity> parked;   // the bodies whose trails were last asked to be parked
+    };
+
+    // Collects the geometry of every object whith a position, a color and a pixel radius, on a screen
+    //  of `w`×`h` pixels
+    // With `splats`, the test particles (the bodies without mass) are drawn as a map of their density, and
+    //  only the other bodies get their own disc
+    // The `predicted` trajectories, if any, are drawn as trails toward the future
+    // The bodies are drawn where `blend` puts them between the two latest states
+    void display(
+        brun::context const & ctx, int const w, int const h, brun::blend const & blend, persistent_trails & trails,
+        orbit_mode & orbits, bool const splats, brun::trajectories const * predicted, brun::frame_geometry & geometry
+    )
+    {
+        auto const & registry = ctx.reg;
+        auto const [view_radius, rotation, camera] = [&ctx, w, h]{
+            return std::shared_lock{ctx}, std::tuple{
+                ctx.view_radius, build_rotation_matrix(ctx.rotation),
+                camera_view{ctx.view_radius, ctx.rotation, ctx.follow, w, h}
+            };
+        }();
+
+        // Rescale the vector such that the screen has "radius" 1.
+        // FIXME this way one cannot see planets in the corner, outside of the circle
+        auto const scale_coeff = 1. / view_radius.count() * std::min(w, h) * 0.5; // px/Gm
+        // Moving to the origin, scaling and rotating are done with a single matrix
+        auto const origin = compute_origin(ctx, blend);
+        auto const view = make_projection(origin, rotation, scale_coeff, w, h);
+
         // We are going to choose which objects to draw.
-        // At first we will compute the displacement of every object from the origin, and rescale it so it
-        //  will be in [0, 1] if it is contained into the screen, (1, +∞) otherwise.
-        // Then we will discard every object whose rescaled displacement is greater than 1 and compute
-        //  the graphics to display (the circle and the motion trail) for every survived object
-        auto entities  = registry.view<brun::position const, SDLpp::color const, brun::px_radius const>();
+        // What is in sight is in a sphere around the origin, whose projection covers the screen: the hierarchy
+        //  of bounding boxes finds the objects which may be in it, and whole pieces of trail out of it are
+        //  skipped. Then we will project the rest on the screen, and compute its distance from the center
+        //  of the screen: if it is greater than half the diagonal, the object is out of the screen.
+        // Then we will discard every object out of the screen and compute the graphics to display (the disc
+        //  and the motion trail) for every survived object
         auto const k = std::hypot(w, h) * 0.5;
-        auto circles = std::vector<SDLpp::paint::circle>(); circles.reserve(registry.size());
-        auto lines   = std::vector<SDLpp::paint::line  >(); lines.reserve(registry.view<brun::trail const>().size());
-        for (auto const entt : entities) {
-            auto const pos = ts_get<brun::position>(ctx, entt);
-            auto const displacement = compute_displacement(pos);
-            auto const rescaled = rescale(displacement);
-            if (brun::norm(rescaled) > k) {
+        auto const body_radius  = k / scale_coeff;          // Gm
+        auto const trail_radius = k * 1.1 / scale_coeff;
+        auto const body_limit  = static_cast<float>(k * k);
+        auto const trail_limit = static_cast<float>(k * k * 1.1 * 1.1);
+        geometry.clear();
+        geometry.sprites.reserve(registry.size());
+        if (not trails.enabled) {
+            geometry.trails = brun::trail_pass::full;
+            trails.view.reset();
+            trails.heads.clear();
+        } else if (not trails.view.has_value() or not same_view(*trails.view, camera)) {
+            geometry.trails = brun::trail_pass::rebuild;
+            trails.view = camera;
+            trails.heads.clear();
+        } else {
+            geometry.trails = brun::trail_pass::increment;
+            geometry.fade = std::pow(0.01f, ImGui::GetIO().DeltaTime / trails.persistence);
+        }
+        auto const frame = ++trails.frame;
+
+        // The positions of the bodies which may be in sight are projected at once; the simulation can't move
+        //  them meanwhile. They are blended between the two latest states
+        // The tree and the buffers are kept from a frame to the next one
+        static auto tree = brun::body_tree{};
+        static auto candidates = std::vector<entt::entity>{};
+        static auto positions = std::vector<brun::position>{};
+        static auto bodies = brun::projected_points{};
+        static auto points = brun::projected_points{};
+        static auto particles = brun::projected_points{};
+        static auto density = brun::density_map{};
+        particles.x.clear();
+        particles.y.clear();
+        auto const lock = std::shared_lock{ctx};
+        if (auto const epoch = ctx.state_epoch.load(std::memory_order::acquire); not orbits.enabled) {
+            orbits.orbits.clear();
+            orbits.bound.clear();
+            orbits.epoch = std::numeric_limits<std::uint64_t>::max();
+        } else if (orbits.epoch != epoch) {
+            brun::compute_orbits(registry, orbits.orbits);
+            orbits.bound.resize(orbits.orbits.size());
+            std::ranges::transform(orbits.orbits, orbits.bound.begin(), &brun::osculating_orbit::body);
+            std::ranges::sort(orbits.bound);
+            orbits.epoch = epoch;
+        }
+        tree.update(
+            registry, ctx.revision.load(std::memory_order::acquire), ctx.travel.load(std::memory_order::acquire),
+            ctx.top_speed.load(std::memory_order::acquire), body_radius
+        );
+        candidates.clear();
+        // Past the last state, the bodies are drawn ahead along their velocity
+        tree.query(origin, body_radius, std::max(blend.t - 1., 0.) * blend.days, candidates);
+        positions.resize(candidates.size());
+        std::ranges::transform(candidates, positions.begin(), [&registry, b = blend](auto const entt) {
+            return brun::blended_position(registry, entt, b);
+        });
+        project(view, positions, bodies);
+
+        // Ends the strip of the last vertices
+        auto const close_strip = [&geometry] {
+            auto const first = geometry.firsts.empty() ? 0 : geometry.firsts.back() + geometry.counts.back();
+            auto const count = static_cast<std::int32_t>(geometry.vertices.size()) - first;
+            if (count >= 2) {
+                geometry.firsts.push_back(first);
+                geometry.counts.push_back(count);
+            } else {
+                geometry.vertices.resize(static_cast<std::size_t>(first));
+            }
+        };
+
+        for (auto n = 0ul; n < candidates.size(); ++n) {
+            auto const entt = candidates[n];
+            if (bodies.distance2[n] > body_limit) {
+                continue;
+            }
+            if (splats) {
+                if (auto const * mass = registry.try_get<brun::mass>(entt); mass != nullptr and mass->count() == 0) {
+                    particles.x.push_back(bodies.x[n]);
+                    particles.y.push_back(bodies.y[n]);
+                    continue;
+                }
+            }
+            if (not registry.has<SDLpp::color, brun::px_radius>(entt)) {
                 continue;
             }
 
-            auto const [color, rad] = ts_get<SDLpp::color, brun::px_radius>(ctx, entt);
-            auto const circle = to_circle(rotate(rescaled), color, rad);
-            circles.push_back(circle);
+            auto const [color, rad] = registry.get<SDLpp::color, brun::px_radius>(entt);
+            auto const [r, g, b, a] = color;
+            auto const x = bodies.x[n], y = bodies.y[n];
+            geometry.sprites.push_back({x, y, rad, pack_color(r, g, b, a)});
 
-            if (not registry.has<brun::trail>(entt)) {
+            if (not registry.has<brun::trail>(entt) or std::ranges::binary_search(orbits.bound, entt)) {
                 continue;
             }
 
-            auto const [r, g, b, a] = color;
-            auto const trail = registry.get<brun::trail>(entt);
-            auto scaled_trail = trail
-                              | std::views::transform(compute_displacement)
-                              | std::views::transform(rescale)
-                              | std::views::filter([k](auto const p) { return brun::norm(p) < k * 1.1; })
-                              | std::views::transform(rotate)
-                              ;
-            auto const alphas = std::views::iota(1ul, trail.size() + 1)
-                              | std::views::transform([s=trail.size()](auto const blending) -> uint8_t {
-                                  return std::lerp(200., 1., blending * 1. / s);
-                              })
-                              ;
-            auto to_line = [&renderer, w,h, r,g,b](auto const pts, auto const alpha) mutable {
-                auto const [p0, p1] = pts;
-                auto const x0 = p0[0] + w/2;
-                auto const y0 = p0[1] + h/2;
-                auto const x1 = p1[0] + w/2;
-                auto const y1 = p1[1] + h/2;
-                return SDLpp::paint::line{renderer, SDLpp::point2d{x0, y0}, {x1, y1}, {r, g, b, alpha}};
-            };
+            // On the persistent canvas only the piece since the previous frame is new; a body which has just
+            //  come into sight starts its trail here
+            if (geometry.trails == brun::trail_pass::increment) {
+                auto const [head, fresh] = trails.heads.try_emplace(entt, persistent_trails::head{x, y, frame});
+                if (not fresh and head->second.frame + 1 == frame) {
+                    auto const first = static_cast<std::int32_t>(geometry.vertices.size());
+                    geometry.vertices.push_back({head->second.x, head->second.y, pack_color(r, g, b, 200)});
+                    geometry.vertices.push_back({x, y, pack_color(r, g, b, 200)});
+                    geometry.firsts.push_back(first);
+                    geometry.counts.push_back(2);
+                }
+                head->second = {x, y, frame};
+                continue;
+            }
 
-            namespace rvw = ::ranges::views;
-            for (auto const [p0, p1, alpha] : rvw::zip(scaled_trail, rvw::tail(scaled_trail), alphas)) {
-                lines.push_back(to_line(std::pair{p0, p1}, alpha));
+            // A trail is a strip of points which fade away; the points outside the screen split the strip
+            // The points are read in place, from the newest to the oldest, a piece of the ring at a time
+            auto const & trail = registry.get<brun::trail>(entt);
+            if (geometry.trails == brun::trail_pass::rebuild) {
+                trails.heads[entt] = {x, y, frame};
+                geometry.vertices.push_back({x, y, pack_color(r, g, b, 200)});
+            }
+            trail.for_each_chunk([&](auto const piece, auto const first, auto const & box) {
+                if (not box.touches(origin, trail_radius)) {
+                    close_strip();
+                    return;
+                }
+                project(view, piece, points);
+                for (auto j = 0ul; j < piece.size(); ++j) {
+                    if (points.distance2[j] >= trail_limit) {
+                        close_strip();
+                        continue;
+                    }
+                    auto const alpha = static_cast<uint8_t>(std::lerp(200., 1., trail.age(first + j)));
+                    geometry.vertices.push_back({points.x[j], points.y[j], pack_color(r, g, b, alpha)});
+                }
+            });
+            close_strip();
+        }
+
+        // An orbit may be in sight even if its body is not; the ones smaller than a pixel are left out
+        for (auto const & orbit : orbits.orbits) {
+            if (not registry.valid(orbit.body) or not registry.valid(orbit.parent)
+                or not registry.has<SDLpp::color>(orbit.body)) {
+                continue;
+            }
+            auto const apoapsis = orbit.a * (1. + orbit.e);
+            auto const focus = brun::blended_position(registry, orbit.parent, blend);
+            if (apoapsis * scale_coeff < 1. or brun::norm(focus - origin).count() - apoapsis > trail_radius) {
+                continue;
+            }
+            auto const [r, g, b, a] = registry.get<SDLpp::color>(orbit.body);
+            points.x.clear();
+            points.y.clear();
+            points.distance2.clear();
+            brun::trace_orbit(orbit, focus, view, 0.5f, points);
+            for (auto j = 0ul; j < points.x.size(); ++j) {
+                if (points.distance2[j] >= trail_limit) {
+                    close_strip();
+                    continue;
+                }
+                geometry.vertices.push_back({points.x[j], points.y[j], pack_color(r, g, b, 120)});
+            }
+            close_strip();
+        }
+
+        // A predicted path fades away toward its end; the bodies removed meanwhile are left out
+        if (predicted != nullptr) {
+            for (auto k = 0ul; k < predicted->bodies.size(); ++k) {
+                auto const entt = predicted->bodies[k];
+                if (not registry.valid(entt) or not registry.has<SDLpp::color>(entt)) {
+                    continue;
+                }
+                auto const [r, g, b, a] = registry.get<SDLpp::color>(entt);
+                auto const path = predicted->path(k);
+                project(view, path, points);
+                for (auto j = 0ul; j < path.size(); ++j) {
+                    if (points.distance2[j] >= trail_limit) {
+                        close_strip();
+                        continue;
+                    }
+                    auto const t = static_cast<double>(j) / static_cast<double>(path.size() - 1);
+                    auto const alpha = static_cast<uint8_t>(std::lerp(160., 20., t));
+                    geometry.vertices.push_back({points.x[j], points.y[j], pack_color(r, g, b, alpha)});
+                }
+                close_strip();
             }
         }
 
-        return std::pair{std::move(circles), std::move(lines)};
+        if (not particles.x.empty()) {
+            geometry.density_peak = density.splat(particles.x, particles.y, w, h, geometry.density);
+        }
     }
 
     template <typename T, typename Variant>
@@ -158,15 +375,56 @@ namespace
     template <typename T>
     constexpr auto follow_idx = index_v<brun::follow_t, T>;
 
+    // An incremental search box over the names of the bodies; the index is queried again only when the text or
+    //  the bodies change
+    struct body_search
+    {
+        std::array<char, 64> query = {};
+        std::string last_query;
+        std::uint64_t revision = std::numeric_limits<std::uint64_t>::max();
+        std::vector<entt::entity> results;
+    };
+
+    // The combos list only this many bodies: the others are found by typing more of their name
+    constexpr auto max_results = std::size_t{100};
+
+    // Draws the search box at the top of an open combo, and returns the bodies to list under it
+    // To be called under the shared lock of the context
+    auto search_bodies(brun::context const & ctx, body_search & search)
+        -> std::span<entt::entity const>
+    {
+        if (ImGui::IsWindowAppearing()) {
+            ImGui::SetKeyboardFocusHere();
+        }
+        ImGui::SetNextItemWidth(-1);
+        ImGui::InputTextWithHint("##search", "search by name", search.query.data(), search.query.size());
+        auto const query = std::string_view{search.query.data()};
+        auto const revision = ctx.revision.load(std::memory_order::acquire);
+        if (query != search.last_query or revision != search.revision) {
+            auto const * index = brun::names(ctx.reg);
+            search.results = index != nullptr ? index->search(query, max_results) : std::vector<entt::entity>{};
+            search.last_query = query;
+            search.revision = revision;
+        }
+        return search.results;
+    }
+
 } // namespace
 
-void draw_camera_settings(brun::context & ctx)
+void draw_camera_settings(
+    brun::context & ctx, persistent_trails & trails, orbit_mode & orbits, bool & splats, bool & software,
+    brun::trajectory_predictor & predictor
+)
 {
     ImGui::Begin("Camera settings");
     auto _1 = std::shared_lock{ctx};
     auto const index = ctx.follow.index();
 
     static auto current_target = std::optional<entt::entity>{std::nullopt};
+    static auto search = body_search{};
+    if (current_target.has_value() and not ctx.reg.valid(*current_target)) {
+        current_target = std::nullopt;
+    }
     auto const follow_com    = ImGui::RadioButton("Center of Mass", index == follow_idx<brun::follow::com>);
     auto const follow_nth    = ImGui::RadioButton("Nothing",        index == follow_idx<brun::follow::nothing>);
     auto const follow_target = ImGui::RadioButton("Target: ",       index == follow_idx<brun::follow::target>);
@@ -176,22 +434,25 @@ void draw_camera_settings(brun::context & ctx)
                                                    : "");
     if (follow_com) {
         ctx.follow = brun::follow::com{};
+        ctx.camera_moved();
     }
     else if (follow_nth) {
         ctx.follow = brun::follow::nothing{absolute_position(ctx.reg, ctx.follow)};
+        ctx.camera_moved();
     }
     else if (follow_target and current_target.has_value()) {
         ctx.follow = brun::follow::target{*current_target};
+        ctx.camera_moved();
     }
     if (show_list) {
         auto const selected = current_target.value_or(static_cast<entt::entity>(-1));
-        auto const group = ctx.reg.view<brun::position const, brun::tag const>();
-        for (auto const entt : group) {
-            auto const & name = group.get<brun::tag const>(entt);
+        for (auto const entt : search_bodies(ctx, search)) {
+            auto const & name = ctx.reg.get<brun::tag>(entt);
             if (ImGui::Selectable(name.c_str(), selected == entt)) {
                 current_target = entt;
                 if (index == follow_idx<brun::follow::target>) {
                     ctx.follow = brun::follow::target{entt};
+                    ctx.camera_moved();
                 }
             }
             if (selected == entt) {
@@ -216,6 +477,37 @@ void draw_camera_settings(brun::context & ctx)
     )) {
         auto _2 = std::scoped_lock{ctx};
         ctx.view_radius = brun::position_scalar{radius_count};
+        ctx.camera_moved();
+    }
+
+    // The software renderer has no persistent canvas, and orbits and predictions are drawn whole at every frame
+    if (not software and not orbits.enabled and not predictor.enabled()) {
+        ImGui::Checkbox("persistent trails", std::addressof(trails.enabled));
+    }
+    if (trails.enabled) {
+        ImGui::SameLine(); ImGui::SetNextItemWidth(150);
+        ImGui::SliderFloat("fade", std::addressof(trails.persistence), 0.5f, 30.f, "%.1f s");
+    }
+    ImGui::Checkbox("density of test particles", std::addressof(splats));
+    if (ImGui::Checkbox("orbits instead of trails", std::addressof(orbits.enabled)) and orbits.enabled) {
+        trails.enabled = false;
+    }
+    // The prediction runs on its own thread: the slider only asks for a new one
+    auto predict = predictor.enabled();
+    if (ImGui::Checkbox("predicted trajectories", std::addressof(predict))) {
+        predictor.enable(predict);
+        trails.enabled = trails.enabled and not predict;
+    }
+    if (predict) {
+        auto horizon = static_cast<float>(predictor.horizon());
+        ImGui::SameLine(); ImGui::SetNextItemWidth(150);
+        if (ImGui::SliderFloat("horizon", std::addressof(horizon), 1.f, 3650.f, "%.0f days",
+                               ImGuiSliderFlags_Logarithmic)) {
+            predictor.set_horizon(horizon);
+        }
+    }
+    if (ImGui::Checkbox("software renderer", std::addressof(software)) and software) {
+        trails.enabled = false;
     }
 
     ImGui::End();
@@ -223,9 +515,18 @@ void draw_camera_settings(brun::context & ctx)
 
 void draw_relative_distances(brun::context & ctx)
 {
+    // The table shows a snapshot of the bodies, taken `refresh_rate` times per second; only the rows in sight
+    //  are formatted, once for every snapshot, so the cost of the window doesn't depend on the number of bodies
+    struct row_cells { std::string name, distance, position, speed, velocity; };
     static auto current_target = std::optional<entt::entity>{std::nullopt};
+    static auto search = body_search{};
     static auto options = std::array<bool, 4>{true, false, true, false};
-    auto _ = std::shared_lock{ctx};
+    static auto refresh_rate = 4.f;     // Hz
+    static auto last_refresh = -std::numeric_limits<double>::infinity();
+    static auto rows = std::vector<entt::entity>{};
+    static auto cells = std::unordered_map<int, row_cells>{};
+    static auto target_pos = brun::position{};
+    static auto target_vel = brun::velocity{};
 
     ImGui::Begin("Data");
     // Structure:
@@ -233,29 +534,48 @@ void draw_relative_distances(brun::context & ctx)
     // ["name"] ["relative position" (opt)] ["relative speed" (opt)]
     // [first]  [first pos (opt)] [first speed (opt)]
 
-    ImGui::SetNextItemWidth(150);
-    auto const show_list = ImGui::BeginCombo("", current_target.has_value()
-                                               ? ctx.reg.get<brun::tag>(*current_target).c_str()
-                                               : "Center of mass");
-    auto const group = ctx.reg.group<brun::position const, brun::velocity const, brun::tag const>();
-    if (show_list) {
-        if (ImGui::Selectable("Center of mass", not current_target.has_value())) {
+    auto const now = ImGui::GetTime();
+    {
+        auto _ = std::shared_lock{ctx};
+        if (current_target.has_value() and not ctx.reg.valid(*current_target)) {
             current_target = std::nullopt;
         }
-        if (not current_target.has_value()) {
-            ImGui::SetItemDefaultFocus();
-        }
-        auto const selected = current_target.value_or(static_cast<entt::entity>(-1));
-        for (auto const entt : group) {
-            auto const & tag = group.get<brun::tag const>(entt);
-            if (ImGui::Selectable(tag.c_str(), selected == entt)) {
-                current_target = entt;
+        ImGui::SetNextItemWidth(150);
+        auto const show_list = ImGui::BeginCombo("", current_target.has_value()
+                                                   ? ctx.reg.get<brun::tag>(*current_target).c_str()
+                                                   : "Center of mass");
+        auto const group = ctx.reg.group<brun::position const, brun::velocity const, brun::tag const>();
+        if (show_list) {
+            if (ImGui::Selectable("Center of mass", not current_target.has_value())) {
+                current_target = std::nullopt;
+                last_refresh = -std::numeric_limits<double>::infinity();
             }
-            if (selected == entt) {
+            if (not current_target.has_value()) {
                 ImGui::SetItemDefaultFocus();
             }
+            auto const selected = current_target.value_or(static_cast<entt::entity>(-1));
+            for (auto const entt : search_bodies(ctx, search)) {
+                auto const & tag = ctx.reg.get<brun::tag>(entt);
+                if (ImGui::Selectable(tag.c_str(), selected == entt)) {
+                    current_target = entt;
+                    last_refresh = -std::numeric_limits<double>::infinity();
+                }
+                if (selected == entt) {
+                    ImGui::SetItemDefaultFocus();
+                }
+            }
+            ImGui::EndCombo();
+        }
+
+        if (now - last_refresh >= 1. / refresh_rate) {
+            rows.assign(group.data(), group.data() + group.size());
+            target_pos = current_target.has_value() ? group.get<brun::position const>(*current_target)
+                                                    : center_of_mass(ctx.reg);
+            target_vel = current_target.has_value() ? group.get<brun::velocity const>(*current_target)
+                                                    : center_of_mass<brun::velocity>(ctx.reg);
+            cells.clear();
+            last_refresh = now;
         }
-        ImGui::EndCombo();
     }
     ImGui::SameLine();
     ImGui::Checkbox("distance (norm)", std::addressof(options[0]));
@@ -265,9 +585,38 @@ void draw_relative_distances(brun::context & ctx)
     ImGui::Checkbox("velocity (norm)", std::addressof(options[2]));
     ImGui::SameLine();
     ImGui::Checkbox("velocity", std::addressof(options.at(3)));
+    ImGui::SameLine(); ImGui::SetNextItemWidth(100);
+    ImGui::SliderFloat("refresh", std::addressof(refresh_rate), 0.5f, 30.f, "%.1f Hz");
+
+    // Formats the rows in [first, last) which are not formatted yet
+    auto const format_rows = [&ctx](int const first, int const last) {
+        auto lock = std::shared_lock{ctx, std::defer_lock};
+        for (auto i = first; i < last; ++i) {
+            if (cells.contains(i)) {
+                continue;
+            }
+            if (not lock.owns_lock()) {
+                lock.lock();
+            }
+            auto & row = cells[i];
+            auto const entt = rows[static_cast<std::size_t>(i)];
+            if (not ctx.reg.valid(entt)) {
+                row.name = "(removed)";
+                continue;
+            }
+            auto const relative_pos = ctx.reg.get<brun::position>(entt) - target_pos;
+            auto const relative_vel = ctx.reg.get<brun::velocity>(entt) - target_vel;
+            row.name     = ctx.reg.get<brun::tag>(entt).view();
+            row.distance = fmt::format("{}", norm(relative_pos));
+            row.position = fmt::format("{}", relative_pos);
+            row.speed    = fmt::format("{}", norm(relative_vel));
+            row.velocity = fmt::format("{}", relative_vel);
+        }
+    };
 
     if (auto const count = std::ranges::count(options, true); count != 0) {
-        ImGui::Columns(count + 1, nullptr, true); // # columns, boh, vertical separators
+        ImGui::BeginChild("rows");
+        ImGui::Columns(static_cast<int>(count) + 1, nullptr, true); // # columns, boh, vertical separators
 
         // Header
         ImGui::Separator();
@@ -290,51 +639,95 @@ void draw_relative_distances(brun::context & ctx)
             ImGui::NextColumn();
         }
 
-        auto const target_pos = current_target.has_value()
-                              ? group.get<brun::position const>(*current_target)
-                              : center_of_mass(ctx.reg);
-
-        auto const target_vel = current_target.has_value()
-                              ? group.get<brun::velocity const>(*current_target)
-                              : center_of_mass<brun::velocity>(ctx.reg);
-
-
-        for (auto const entt : group) {
-            auto const & tag = group.get<brun::tag const>(entt);
-            auto const relative_pos = group.get<brun::position const>(entt) - target_pos;
-            auto const relative_vel = group.get<brun::velocity const>(entt) - target_vel;
-            ImGui::Separator();
-            ImGui::Text("%s", tag.c_str());
-            ImGui::NextColumn();
-            if (options[0]) {
-                auto const abs_pos = fmt::format("{}", norm(relative_pos));
-                ImGui::Text("%s", abs_pos.c_str());
-                ImGui::NextColumn();
-            }
-            if (options[1]) {
-                auto const pos     = fmt::format("{}", relative_pos);
-                ImGui::Text("%s", pos.c_str());
-                ImGui::NextColumn();
-            }
-            if (options[2]) {
-                auto const abs_vel = fmt::format("{}", norm(relative_vel));
-                ImGui::Text("%s", abs_vel.c_str());
-                ImGui::NextColumn();
-            }
-            if (options[3]) {
-                auto const vel     = fmt::format("{}", relative_vel);
-                ImGui::Text("%s", vel.c_str());
+        // Only the rows in sight are laid out
+        auto clipper = ImGuiListClipper{};
+        clipper.Begin(static_cast<int>(rows.size()));
+        while (clipper.Step()) {
+            format_rows(clipper.DisplayStart, clipper.DisplayEnd);
+            for (auto i = clipper.DisplayStart; i < clipper.DisplayEnd; ++i) {
+                auto const & row = cells[i];
+                ImGui::Separator();
+                ImGui::Text("%s", row.name.c_str());
                 ImGui::NextColumn();
+                if (options[0]) {
+                    ImGui::Text("%s", row.distance.c_str());
+                    ImGui::NextColumn();
+                }
+                if (options[1]) {
+                    ImGui::Text("%s", row.position.c_str());
+                    ImGui::NextColumn();
+                }
+                if (options[2]) {
+                    ImGui::Text("%s", row.speed.c_str());
+                    ImGui::NextColumn();
+                }
+                if (options[3]) {
+                    ImGui::Text("%s", row.velocity.c_str());
+                    ImGui::NextColumn();
+                }
             }
         }
+        clipper.End();
         ImGui::Columns(1);
         ImGui::Separator();
+        ImGui::EndChild();
     }
 
     ImGui::End();
 }
 
-void draw_graphics(brun::context & ctx, SDLpp::renderer & renderer, SDLpp::window const & window) {
+void build_geometry(
+    brun::context const & ctx, int const width, int const height, bool const splats, brun::frame_geometry & geometry
+) {
+    // A recorded frame shows the last state, whatever the time it is drawn at
+    auto trails = persistent_trails{};
+    auto orbits = orbit_mode{};
+    display(ctx, width, height, brun::blend{}, trails, orbits, splats, nullptr, geometry);
+}
+
+auto draw_graphics(
+    brun::context & ctx, SDLpp::renderer & renderer, SDLpp::window const & window, brun::gl_scene & scene,
+    brun::frame_pacer const & pacer, brun::trajectory_predictor & predictor, std::uint64_t const ui_epoch
+) -> bool {
+    // ImGui needs a few frames to settle after an input (e.g. a popup appears at the second one)
+    constexpr auto settle_frames = 3;
+    static auto trails = persistent_trails{};
+    static auto orbits = orbit_mode{};
+    static auto splats = false;
+    static auto software = false;
+    // The frames drawn on the CPU are shown as an image
+    static auto raster = brun::software_scene{};
+    static auto image = brun::rgb_image{};
+    static auto raster_time = std::chrono::duration<double, std::milli>{0};
+    // The buffers of the geometry are kept from a frame to the next one
+    static auto geometry = brun::frame_geometry{};
+    static auto drawn = std::optional<scene_epochs>{};  // the scene in `geometry`, if it stays still
+    static auto last_ui = std::numeric_limits<std::uint64_t>::max();
+    static auto settling = 0;
+
+    auto const [_a, _b, w, h] = renderer.size(); // get width and height
+    auto const current_scene = [&ctx, &predictor, width = w, height = h] {
+        return scene_epochs{
+            ctx.state_epoch.load(std::memory_order::acquire), ctx.camera_epoch.load(std::memory_order::acquire),
+            width, height, trails.enabled, splats, software, orbits.enabled, predictor.published()
+        };
+    };
+    // On the screen the bodies move between two states with the time of the frame
+    auto const current_blend = [&ctx] {
+        auto const _ = std::shared_lock{ctx};
+        return brun::make_blend(ctx, std::chrono::steady_clock::now());
+    };
+    if (ui_epoch != last_ui) {
+        last_ui = ui_epoch;
+        settling = settle_frames;
+    }
+    // Persistent trails fade with time, and a text field shows its cursor blinking
+    auto const idle = settling == 0 and not trails.enabled and not ImGui::GetIO().WantTextInput;
+    if (idle and drawn == current_scene() and current_blend().still()) {
+        return false;
+    }
+    settling = std::max(settling - 1, 0);
+
     ImGui_ImplOpenGL3_NewFrame();
     ImGui_ImplSDL2_NewFrame(window.handler());
     ImGui::NewFrame();
@@ -347,24 +740,57 @@ void draw_graphics(brun::context & ctx, SDLpp::renderer & renderer, SDLpp::windo
         if (ImGui::Button("Button")) { button = not button; }
         ImGui::Text("Button is pressed: %s\n", button ? "true " : "false");
         ImGui::Text("Current framerate: %.1f FPS", ImGui::GetIO().Framerate);
+        auto const & frames = pacer.histogram();
+        ImGui::Text("Frame time: p50 %.2f ms, p99 %.2f ms, max %.2f ms",
+                    frames.percentile(0.5).count(), frames.percentile(0.99).count(), frames.max().count());
+        ImGui::Text("Frames dropped: %llu, skipped: %llu", static_cast<unsigned long long>(pacer.dropped()),
+                    static_cast<unsigned long long>(pacer.skipped()));
+        if (software) {
+            ImGui::Text("Software rasterizer: %.2f ms", raster_time.count());
+        }
         ImGui::End();
     }
 
-    draw_camera_settings(ctx);
+    draw_camera_settings(ctx, trails, orbits, splats, software, predictor);
 
     draw_relative_distances(ctx);
 
-    // Make the screen black
-    auto const [circles, lines] = display(ctx, renderer);
-    {
-        std::ranges::for_each(lines,   &SDLpp::paint::line  ::display); // Draw motion trail first,
-        std::ranges::for_each(circles, &SDLpp::paint::circle::display); //  then circles, on the "canvas"
+    // The widgets may have moved the camera: the geometry is built again only if something changed. A
+    //  persistent canvas takes new pieces of trail at every frame
+    auto const scene_now = current_scene();
+    if (trails.enabled or drawn != scene_now) {
+        auto const blend = current_blend();
+        auto const & predicted = predictor.latest();
+        display(
+            ctx, w, h, blend, trails, orbits, splats, predicted.bodies.empty() ? nullptr : &predicted, geometry
+        );
+        drawn = blend.still() ? std::optional{scene_now} : std::nullopt;
+        if (software) {
+            auto const start = std::chrono::steady_clock::now();
+            raster.draw(geometry, w, h, image);
+            raster_time = std::chrono::steady_clock::now() - start;
+        }
     }
+
+    // The trails of the bodies drawn as orbits aren't needed: the simulation parks them
+    if (orbits.bound != orbits.parked) {
+        orbits.parked = orbits.bound;
+        ctx.defer([bound = orbits.parked](brun::context & c) { brun::park_trails(c.reg, bound); });
+    }
+
+    // Make the screen black, then draw trails and bodies (in two draw calls, or as the image drawn on the CPU)
+    //  and the UI over them
     ImGui::Render();
     glClearColor(0.00f, 0.00f, 0.00f, 1.00f);
     glClear(GL_COLOR_BUFFER_BIT);
+    if (software) {
+        scene.draw_image(image, w, h);
+    } else {
+        scene.draw(geometry, w, h);
+    }
     ImGui_ImplOpenGL3_RenderDrawData(ImGui::GetDrawData());
     renderer.present(); // Display the canvas (calls `SDL_GL_SwapWindow` inside)
+    return true;
 }
 } // namespace brun
 
@@ -0,0 +1,470 @@
+/**
+ * @author      : Riccardo Brugo (brugo.riccardo@gmail.com)
+ * @file        : gl_scene
+ * @created     : Saturday Oct 17, 2026 16:55:37 CEST
+ * @license     : MIT
+ */
+
+#include "gl_scene.hpp"
+
+#include <string>
+#include <cstring>
+#include <algorithm>
+
+#include <fmt/format.h>
+
+namespace brun
+{
+
+namespace
+{
+    // Bodies are quads (two triangles, from gl_VertexID) around their center, one instance per body;
+    //  the fragment shader cuts a disc out of them, with one pixel of antialiasing
+    constexpr auto sprite_vertex_shader = R"(
+        #version 430 core
+        layout(location = 0) in vec2 center;
+        layout(location = 1) in float radius;
+        layout(location = 2) in vec4 color;
+        uniform vec2 viewport;
+        out vec2 offset;
+        out vec4 tint;
+        out float size;
+        void main() {
+            vec2 corner = vec2(gl_VertexID & 1, gl_VertexID >> 1) * 2.0 - 1.0;
+            offset = corner * (radius + 1.0);
+            tint = color;
+            size = radius;
+            vec2 px = center + offset;
+            gl_Position = vec4(px.x / viewport.x * 2.0 - 1.0, 1.0 - px.y / viewport.y * 2.0, 0.0, 1.0);
+        }
+    )";
+    constexpr auto sprite_fragment_shader = R"(
+        #version 430 core
+        in vec2 offset;
+        in vec4 tint;
+        in float size;
+        out vec4 frag_color;
+        void main() {
+            float coverage = clamp(size + 0.5 - length(offset), 0.0, 1.0);
+            if (coverage <= 0.0) {
+                discard;
+            }
+            frag_color = vec4(tint.rgb, tint.a * coverage);
+        }
+    )";
+    constexpr auto trail_vertex_shader = R"(
+        #version 430 core
+        layout(location = 0) in vec2 position;
+        layout(location = 1) in vec4 color;
+        uniform vec2 viewport;
+        out vec4 tint;
+        void main() {
+            tint = color;
+            gl_Position = vec4(position.x / viewport.x * 2.0 - 1.0, 1.0 - position.y / viewport.y * 2.0, 0.0, 1.0);
+        }
+    )";
+    constexpr auto trail_fragment_shader = R"(
+        #version 430 core
+        in vec4 tint;
+        out vec4 frag_color;
+        void main() {
+            frag_color = tint;
+        }
+    )";
+
+    // A triangle which covers the whole screen, from gl_VertexID; `uv` spans [0, 1] on the screen
+    constexpr auto screen_vertex_shader = R"(
+        #version 430 core
+        out vec2 uv;
+        void main() {
+            uv = vec2((gl_VertexID << 1) & 2, gl_VertexID & 2);
+            gl_Position = vec4(uv * 2.0 - 1.0, 0.0, 1.0);
+        }
+    )";
+    // Drawn with glBlendFunc(GL_ZERO, GL_SRC_COLOR): multiplies the canvas by `keep`
+    constexpr auto fade_fragment_shader = R"(
+        #version 430 core
+        uniform float keep;
+        out vec4 frag_color;
+        void main() {
+            frag_color = vec4(keep);
+        }
+    )";
+    constexpr auto blit_fragment_shader = R"(
+        #version 430 core
+        in vec2 uv;
+        uniform sampler2D canvas;
+        out vec4 frag_color;
+        void main() {
+            frag_color = texture(canvas, uv);
+        }
+    )";
+    // The rows of an image go from the top of the screen, the ones of a texture from the bottom
+    constexpr auto image_fragment_shader = R"(
+        #version 430 core
+        in vec2 uv;
+        uniform sampler2D image;
+        out vec4 frag_color;
+        void main() {
+            frag_color = vec4(texture(image, vec2(uv.x, 1.0 - uv.y)).rgb, 1.0);
+        }
+    )";
+
+    // The counts are mapped on a logarithmic scale to the "inferno" colormap (a polynomial fit of it); the
+    //  empty pixels are left transparent
+    constexpr auto density_fragment_shader = R"(
+        #version 430 core
+        uniform sampler2D density;
+        uniform float peak;
+        out vec4 frag_color;
+        vec3 inferno(float t) {
+            const vec3 c0 = vec3(0.0002189403691192265, 0.001651004631001012, -0.01948089843709184);
+            const vec3 c1 = vec3(0.1065134194856116, 0.5639564367884091, 3.932712388889277);
+            const vec3 c2 = vec3(11.60249308247187, -3.972853965665698, -15.9423941062914);
+            const vec3 c3 = vec3(-41.70399613139459, 17.43639888205313, 44.35414519872813);
+            const vec3 c4 = vec3(77.162935699427, -33.40235894210092, -81.80730925738993);
+            const vec3 c5 = vec3(-71.31942824499214, 32.62606426397723, 73.20951985803202);
+            const vec3 c6 = vec3(25.13112622477341, -12.24266895238567, -23.07032500287172);
+            return c0 + t * (c1 + t * (c2 + t * (c3 + t * (c4 + t * (c5 + t * c6)))));
+        }
+        void main() {
+            ivec2 size = textureSize(density, 0);
+            ivec2 pixel = ivec2(gl_FragCoord.xy);
+            float count = texelFetch(density, ivec2(pixel.x, size.y - 1 - pixel.y), 0).r;
+            if (count <= 0.0) {
+                discard;
+            }
+            float t = log(1.0 + count) / log(1.0 + peak);
+            float alpha = clamp(0.35 + t, 0.0, 1.0);
+            frag_color = vec4(inferno(0.15 + 0.85 * t) * alpha, alpha);
+        }
+    )";
+
+    constexpr auto sprite_binding = GLuint{0};
+    constexpr auto vertex_binding = GLuint{0};
+
+    auto compile(GLenum const type, char const * source)
+        -> GLuint
+    {
+        auto const shader = glCreateShader(type);
+        glShaderSource(shader, 1, &source, nullptr);
+        glCompileShader(shader);
+        auto status = GLint{};
+        glGetShaderiv(shader, GL_COMPILE_STATUS, &status);
+        if (status != GL_TRUE) {
+            auto log = std::string(1024, '\0');
+            glGetShaderInfoLog(shader, static_cast<GLsizei>(log.size()), nullptr, log.data());
+            fmt::print(stderr, "Error - can't compile a shader: {}\n", log.c_str());
+        }
+        return shader;
+    }
+
+    auto link(char const * vertex_source, char const * fragment_source)
+        -> GLuint
+    {
+        auto const vertex   = compile(GL_VERTEX_SHADER, vertex_source);
+        auto const fragment = compile(GL_FRAGMENT_SHADER, fragment_source);
+        auto const program  = glCreateProgram();
+        glAttachShader(program, vertex);
+        glAttachShader(program, fragment);
+        glLinkProgram(program);
+        glDeleteShader(vertex);
+        glDeleteShader(fragment);
+        auto status = GLint{};
+        glGetProgramiv(program, GL_LINK_STATUS, &status);
+        if (status != GL_TRUE) {
+            auto log = std::string(1024, '\0');
+            glGetProgramInfoLog(program, static_cast<GLsizei>(log.size()), nullptr, log.data());
+            fmt::print(stderr, "Error - can't link a shader program: {}\n", log.c_str());
+        }
+        return program;
+    }
+
+    void wait_for(GLsync & fence) noexcept
+    {
+        if (fence == nullptr) {
+            return;
+        }
+        constexpr auto timeout = GLuint64{1'000'000};   // ns
+        while (glClientWaitSync(fence, GL_SYNC_FLUSH_COMMANDS_BIT, timeout) == GL_TIMEOUT_EXPIRED) {
+            ;
+        }
+        glDeleteSync(fence);
+        fence = nullptr;
+    }
+} // namespace
+
+void stream_buffer::release() noexcept
+{
+    std::ranges::for_each(_fences, wait_for);
+    if (_id != 0) {
+        if (_mapped != nullptr) {
+            glBindBuffer(GL_ARRAY_BUFFER, _id);
+            glUnmapBuffer(GL_ARRAY_BUFFER);
+        }
+        glDeleteBuffers(1, &_id);
+    }
+    _id = 0;
+    _mapped = nullptr;
+    _region_size = 0;
+}
+
+void stream_buffer::allocate(std::size_t const region_size)
+{
+    release();
+    glGenBuffers(1, &_id);
+    glBindBuffer(GL_ARRAY_BUFFER, _id);
+    _region_size = region_size;
+    _current = 0;
+    if (GLEW_ARB_buffer_storage) {
+        constexpr auto flags = GL_MAP_WRITE_BIT | GL_MAP_PERSISTENT_BIT | GL_MAP_COHERENT_BIT;
+        auto const size = static_cast<GLsizeiptr>(region_size * regions);
+        glBufferStorage(GL_ARRAY_BUFFER, size, nullptr, flags);
+        _mapped = glMapBufferRange(GL_ARRAY_BUFFER, 0, size, flags);
+    }
+}
+
+auto stream_buffer::push(void const * data, std::size_t const size)
+    -> GLintptr
+{
+    if (size > _region_size or _id == 0) {
+        allocate(std::max({size, _region_size * 2, std::size_t{4096}}));
+    }
+    if (_mapped == nullptr) {
+        // No persistent mapping: the old storage is orphaned, the driver takes care of the synchronization
+        glBindBuffer(GL_ARRAY_BUFFER, _id);
+        glBufferData(GL_ARRAY_BUFFER, static_cast<GLsizeiptr>(_region_size), nullptr, GL_STREAM_DRAW);
+        glBufferSubData(GL_ARRAY_BUFFER, 0, static_cast<GLsizeiptr>(size), data);
+        return 0;
+    }
+    wait_for(_fences[_current]);  // the GPU may still be reading this region from three frames ago
+    auto const offset = static_cast<std::size_t>(_current) * _region_size;
+    std::memcpy(static_cast<std::byte *>(_mapped) + offset, data, size);
+    return static_cast<GLintptr>(offset);
+}
+
+void stream_buffer::fence()
+{
+    if (_mapped == nullptr) {
+        return;
+    }
+    _fences[_current] = glFenceSync(GL_SYNC_GPU_COMMANDS_COMPLETE, 0);
+    _current = (_current + 1) % regions;
+}
+
+gl_scene::gl_scene()
+{
+    _sprite_program = link(sprite_vertex_shader, sprite_fragment_shader);
+    _trail_program  = link(trail_vertex_shader, trail_fragment_shader);
+    _fade_program   = link(screen_vertex_shader, fade_fragment_shader);
+    _blit_program   = link(screen_vertex_shader, blit_fragment_shader);
+    _density_program = link(screen_vertex_shader, density_fragment_shader);
+    _image_program  = link(screen_vertex_shader, image_fragment_shader);
+
+    // The layout of the attributes is given once; the buffers are bound at every frame
+    glGenVertexArrays(1, &_sprite_vao);
+    glBindVertexArray(_sprite_vao);
+    glEnableVertexAttribArray(0);
+    glEnableVertexAttribArray(1);
+    glEnableVertexAttribArray(2);
+    glVertexAttribFormat(0, 2, GL_FLOAT, GL_FALSE, offsetof(brun::sprite, x));
+    glVertexAttribFormat(1, 1, GL_FLOAT, GL_FALSE, offsetof(brun::sprite, radius));
+    glVertexAttribFormat(2, 4, GL_UNSIGNED_BYTE, GL_TRUE, offsetof(brun::sprite, color));
+    glVertexAttribBinding(0, sprite_binding);
+    glVertexAttribBinding(1, sprite_binding);
+    glVertexAttribBinding(2, sprite_binding);
+    glVertexBindingDivisor(sprite_binding, 1);
+
+    glGenVertexArrays(1, &_trail_vao);
+    glBindVertexArray(_trail_vao);
+    glEnableVertexAttribArray(0);
+    glEnableVertexAttribArray(1);
+    glVertexAttribFormat(0, 2, GL_FLOAT, GL_FALSE, offsetof(brun::trail_vertex, x));
+    glVertexAttribFormat(1, 4, GL_UNSIGNED_BYTE, GL_TRUE, offsetof(brun::trail_vertex, color));
+    glVertexAttribBinding(0, vertex_binding);
+    glVertexAttribBinding(1, vertex_binding);
+
+    // The full screen triangle has no attributes, but a core context needs a vertex array anyway
+    glGenVertexArrays(1, &_screen_vao);
+    glGenFramebuffers(1, &_canvas_fbo);
+    glBindVertexArray(0);
+}
+
+gl_scene::~gl_scene()
+{
+    glDeleteVertexArrays(1, &_sprite_vao);
+    glDeleteVertexArrays(1, &_trail_vao);
+    glDeleteVertexArrays(1, &_screen_vao);
+    glDeleteFramebuffers(1, &_canvas_fbo);
+    glDeleteTextures(1, &_canvas_texture);
+    glDeleteTextures(1, &_density_texture);
+    glDeleteTextures(1, &_image_texture);
+    glDeleteProgram(_sprite_program);
+    glDeleteProgram(_trail_program);
+    glDeleteProgram(_fade_program);
+    glDeleteProgram(_blit_program);
+    glDeleteProgram(_density_program);
+    glDeleteProgram(_image_program);
+}
+
+void gl_scene::resize_canvas(int const width, int const height)
+{
+    // Half floats, because fading an 8 bit channel by a few percent at a time gets stuck above zero
+    glDeleteTextures(1, &_canvas_texture);
+    glGenTextures(1, &_canvas_texture);
+    glBindTexture(GL_TEXTURE_2D, _canvas_texture);
+    glTexStorage2D(GL_TEXTURE_2D, 1, GL_RGBA16F, width, height);
+    glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_MIN_FILTER, GL_NEAREST);
+    glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_MAG_FILTER, GL_NEAREST);
+    glBindFramebuffer(GL_FRAMEBUFFER, _canvas_fbo);
+    glFramebufferTexture2D(GL_FRAMEBUFFER, GL_COLOR_ATTACHMENT0, GL_TEXTURE_2D, _canvas_texture, 0);
+    if (glCheckFramebufferStatus(GL_FRAMEBUFFER) != GL_FRAMEBUFFER_COMPLETE) {
+        fmt::print(stderr, "Error - the trail canvas is not a complete framebuffer\n");
+    }
+    glBindFramebuffer(GL_FRAMEBUFFER, 0);
+    _canvas_width  = width;
+    _canvas_height = height;
+}
+
+void gl_scene::draw_trails(brun::frame_geometry const & geometry, int const width, int const height)
+{
+    if (geometry.counts.empty()) {
+        return;
+    }
+    auto const & vertices = geometry.vertices;
+    auto const offset = _vertices.push(vertices.data(), vertices.size() * sizeof(brun::trail_vertex));
+    glUseProgram(_trail_program);
+    glUniform2f(glGetUniformLocation(_trail_program, "viewport"), float(width), float(height));
+    glBindVertexArray(_trail_vao);
+    glBindVertexBuffer(vertex_binding, _vertices.id(), offset, sizeof(brun::trail_vertex));
+    glMultiDrawArrays(GL_LINE_STRIP, geometry.firsts.data(), geometry.counts.data(),
+                      static_cast<GLsizei>(geometry.counts.size()));
+    _vertices.fence();
+}
+
+void gl_scene::accumulate_trails(brun::frame_geometry const & geometry, int const width, int const height)
+{
+    auto const resized = width != _canvas_width or height != _canvas_height;
+    if (resized) {
+        resize_canvas(width, height);
+    }
+
+    glBindFramebuffer(GL_FRAMEBUFFER, _canvas_fbo);
+    glBindVertexArray(_screen_vao);
+    if (resized or geometry.trails == brun::trail_pass::rebuild) {
+        constexpr auto transparent = std::array{0.f, 0.f, 0.f, 0.f};
+        glClearBufferfv(GL_COLOR, 0, transparent.data());
+    } else {
+        glUseProgram(_fade_program);
+        glUniform1f(glGetUniformLocation(_fade_program, "keep"), geometry.fade);
+        glBlendFunc(GL_ZERO, GL_SRC_COLOR);
+        glDrawArrays(GL_TRIANGLES, 0, 3);
+    }
+    // The canvas holds premultiplied colors
+    glBlendFuncSeparate(GL_SRC_ALPHA, GL_ONE_MINUS_SRC_ALPHA, GL_ONE, GL_ONE_MINUS_SRC_ALPHA);
+    draw_trails(geometry, width, height);
+    glBindFramebuffer(GL_FRAMEBUFFER, 0);
+
+    glUseProgram(_blit_program);
+    glBindVertexArray(_screen_vao);
+    glActiveTexture(GL_TEXTURE0);
+    glBindTexture(GL_TEXTURE_2D, _canvas_texture);
+    glUniform1i(glGetUniformLocation(_blit_program, "canvas"), 0);
+    glBlendFunc(GL_ONE, GL_ONE_MINUS_SRC_ALPHA);
+    glDrawArrays(GL_TRIANGLES, 0, 3);
+    glBlendFunc(GL_SRC_ALPHA, GL_ONE_MINUS_SRC_ALPHA);
+}
+
+void gl_scene::draw_density(brun::frame_geometry const & geometry, int const width, int const height)
+{
+    if (geometry.density.size() != static_cast<std::size_t>(width) * static_cast<std::size_t>(height)) {
+        return;
+    }
+    if (width != _density_width or height != _density_height) {
+        glDeleteTextures(1, &_density_texture);
+        glGenTextures(1, &_density_texture);
+        glBindTexture(GL_TEXTURE_2D, _density_texture);
+        glTexStorage2D(GL_TEXTURE_2D, 1, GL_R32F, width, height);
+        _density_width  = width;
+        _density_height = height;
+    }
+    glActiveTexture(GL_TEXTURE0);
+    glBindTexture(GL_TEXTURE_2D, _density_texture);
+    glPixelStorei(GL_UNPACK_ALIGNMENT, 4);
+    glTexSubImage2D(GL_TEXTURE_2D, 0, 0, 0, width, height, GL_RED, GL_FLOAT, geometry.density.data());
+
+    glUseProgram(_density_program);
+    glUniform1i(glGetUniformLocation(_density_program, "density"), 0);
+    glUniform1f(glGetUniformLocation(_density_program, "peak"), std::max(geometry.density_peak, 1.f));
+    glBindVertexArray(_screen_vao);
+    glBlendFunc(GL_ONE, GL_ONE_MINUS_SRC_ALPHA);
+    glDrawArrays(GL_TRIANGLES, 0, 3);
+    glBlendFunc(GL_SRC_ALPHA, GL_ONE_MINUS_SRC_ALPHA);
+}
+
+void gl_scene::draw(brun::frame_geometry const & geometry, int const width, int const height)
+{
+    glViewport(0, 0, width, height);
+    glDisable(GL_DEPTH_TEST);
+    glDisable(GL_SCISSOR_TEST);
+    glEnable(GL_BLEND);
+    glBlendFunc(GL_SRC_ALPHA, GL_ONE_MINUS_SRC_ALPHA);
+
+    // Motion trails first, then the test particles and the bodies over them
+    if (geometry.trails == brun::trail_pass::full) {
+        draw_trails(geometry, width, height);
+    } else {
+        accumulate_trails(geometry, width, height);
+    }
+    if (not geometry.density.empty()) {
+        draw_density(geometry, width, height);
+    }
+
+    if (not geometry.sprites.empty()) {
+        auto const & sprites = geometry.sprites;
+        auto const offset = _sprites.push(sprites.data(), sprites.size() * sizeof(brun::sprite));
+        glUseProgram(_sprite_program);
+        glUniform2f(glGetUniformLocation(_sprite_program, "viewport"), float(width), float(height));
+        glBindVertexArray(_sprite_vao);
+        glBindVertexBuffer(sprite_binding, _sprites.id(), offset, sizeof(brun::sprite));
+        glDrawArraysInstanced(GL_TRIANGLE_STRIP, 0, 4, static_cast<GLsizei>(sprites.size()));
+        _sprites.fence();
+    }
+
+    glBindVertexArray(0);
+    glUseProgram(0);
+}
+
+void gl_scene::draw_image(brun::rgb_image const & image, int const width, int const height)
+{
+    if (image.pixels.empty()) {
+        return;
+    }
+    if (image.width != _image_width or image.height != _image_height) {
+        glDeleteTextures(1, &_image_texture);
+        glGenTextures(1, &_image_texture);
+        glBindTexture(GL_TEXTURE_2D, _image_texture);
+        glTexStorage2D(GL_TEXTURE_2D, 1, GL_RGB8, image.width, image.height);
+        glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_MIN_FILTER, GL_NEAREST);
+        glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_MAG_FILTER, GL_NEAREST);
+        _image_width  = image.width;
+        _image_height = image.height;
+    }
+    glActiveTexture(GL_TEXTURE0);
+    glBindTexture(GL_TEXTURE_2D, _image_texture);
+    glPixelStorei(GL_UNPACK_ALIGNMENT, 1);
+    glTexSubImage2D(GL_TEXTURE_2D, 0, 0, 0, image.width, image.height, GL_RGB, GL_UNSIGNED_BYTE, image.pixels.data());
+    glPixelStorei(GL_UNPACK_ALIGNMENT, 4);
+
+    glViewport(0, 0, width, height);
+    glDisable(GL_BLEND);
+    glUseProgram(_image_program);
+    glUniform1i(glGetUniformLocation(_image_program, "image"), 0);
+    glBindVertexArray(_screen_vao);
+    glDrawArrays(GL_TRIANGLES, 0, 3);
+    glEnable(GL_BLEND);
+    glBindVertexArray(0);
+    glUseProgram(0);
+}
+
+} // namespace brun
@@ -0,0 +1,125 @@
+/**
+ * @author      : Riccardo Brugo (brugo.riccardo@gmail.com)
+ * @file        : injector
+ * @created     : Saturday Oct 17, 2026 16:15:03 CEST
+ * @license     : MIT
+ */
+
+#include "injector.hpp"
+#include "catalog.hpp"
+
+#include <array>
+#include <vector>
+#include <fstream>
+
+#include <fcntl.h>                   // open
+#include <poll.h>                    // poll
+#include <unistd.h>                  // read, close
+
+#include <fmt/format.h>
+#include <fmt/ostream.h>
+
+namespace brun
+{
+
+namespace
+{
+    constexpr auto poll_timeout = 200;  // ms, how often the stop token is checked
+
+    // Attributes of the bodies which don't have their own
+    auto const     default_color     = SDLpp::color{0xFF, 0xFF, 0xFF};
+    constexpr auto default_px_radius = brun::px_radius{3.f};
+} // namespace
+
+body_injector::body_injector(brun::context & ctx, std::filesystem::path path)
+    : _ctx{ctx}, _path{std::move(path)}, _defaults{default_color, default_px_radius, 0}
+{
+    if (std::filesystem::is_fifo(_path)) {
+        _thread = std::jthread{[this](std::stop_token const stop) { read_pipe(stop); }};
+        return;
+    }
+    // Only the lines appended from now on are read
+    auto error = std::error_code{};
+    auto const size = std::filesystem::file_size(_path, error);
+    _offset  = error ? 0 : size;
+    _watcher = std::make_unique<brun::file_watcher>(
+        std::vector{_path}, [this](auto const &) { read_spool(); }, brun::file_watcher::trigger::modified
+    );
+}
+
+void body_injector::read_pipe(std::stop_token const & stop)
+{
+    // Opened for writing too, so the pipe never reaches its end when a writer leaves
+    auto const fd = ::open(_path.c_str(), O_RDWR | O_NONBLOCK | O_CLOEXEC);
+    if (fd < 0) {
+        fmt::print(stderr, "Warning - can't open {}, no body will be injected\n", _path);
+        return;
+    }
+    auto buffer = std::array<char, 65536>{};
+    while (not stop.stop_requested()) {
+        auto pending = pollfd{fd, POLLIN, 0};
+        if (::poll(&pending, 1, poll_timeout) <= 0) {
+            continue;
+        }
+        for (auto size = ::read(fd, buffer.data(), buffer.size()); size > 0;
+                  size = ::read(fd, buffer.data(), buffer.size())) {
+            consume(std::string_view{buffer.data(), static_cast<std::size_t>(size)});
+        }
+    }
+    ::close(fd);
+}
+
+void body_injector::read_spool()
+{
+    auto file = std::ifstream{_path, std::ios::binary | std::ios::ate};
+    if (not file.is_open()) {
+        return;
+    }
+    auto const size = static_cast<std::uint64_t>(file.tellg());
+    if (size < _offset) {
+        // The file has been truncated or replaced: start again
+        _offset = 0;
+        _partial.clear();
+    }
+    auto data = std::string(size - _offset, '\0');
+    file.seekg(static_cast<std::streamoff>(_offset));
+    file.read(data.data(), static_cast<std::streamsize>(data.size()));
+    _offset += static_cast<std::uint64_t>(file.gcount());
+    data.resize(static_cast<std::size_t>(file.gcount()));
+    consume(data);
+}
+
+void body_injector::consume(std::string_view const data)
+{
+    _partial += data;
+    auto const end = _partial.rfind('\n');
+    if (end == std::string::npos) {
+        return;
+    }
+
+    auto bodies = std::vector<brun::body_record>{};
+    auto lines = std::string_view{_partial}.substr(0, end);
+    while (not lines.empty()) {
+        auto const eol  = lines.find('\n');
+        auto const line = lines.substr(0, eol);
+        lines.remove_prefix(eol == std::string_view::npos ? lines.size() : eol + 1);
+        if (line.find_first_not_of(" \t\r") == std::string_view::npos or line.front() == '#') {
+            continue;
+        }
+        if (auto body = brun::parse_body_line(line, _defaults); body.has_value()) {
+            bodies.push_back(std::move(*body));
+        } else {
+            fmt::print(stderr, "Warning - can't inject the body \"{}\"\n", line);
+        }
+    }
+    _partial.erase(0, end + 1);
+
+    if (not bodies.empty()) {
+        _ctx.defer([bodies = std::move(bodies)](brun::context & ctx) mutable {
+            fmt::print("Injected {} bodies\n", bodies.size());
+            brun::insert_bodies(ctx.reg, std::move(bodies));
+        });
+    }
+}
+
+} // namespace brun
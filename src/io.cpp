@@ -7,6 +7,8 @@
 
 #include "io.hpp"
 #include "gfx.hpp"
+#include "pacer.hpp"
+#include "prediction.hpp"
 #include "common.hpp"
 #include "simulation_params.hpp"
 
@@ -90,7 +92,9 @@ namespace
         return ImGui::GetIO();
     }
 
+    // Handles the pending events, and returns how many there were
     auto io_events(brun::context & ctx)
+        -> std::size_t
     {
         constexpr auto input_delay = std::chrono::milliseconds{10};
         auto changes = std::uint8_t{0};
@@ -102,7 +106,9 @@ namespace
         /* constexpr auto sin = std::sin(M_PI/100); */
         /* constexpr auto cos = std::cos(M_PI/100); */
         auto rotation = brun::rotation_info{};
+        auto events = std::size_t{0};
         for (auto const event : SDLpp::event_range) {
+            ++events;
             ImGui_ImplSDL2_ProcessEvent(std::addressof(event.handler()));
             auto const input = SDLpp::match(event,
                  [](SDLpp::event_category::quit) { return +'q'; },
@@ -192,18 +198,9 @@ namespace
                     follow.offset = follow.offset + brun::build_reversed_rotation_matrix(ctx.rotation) * displacement;
                 }, ctx.follow);
             }
+            ctx.camera_moved();
         }
-    }
-
-    void update_trail(brun::context & ctx)
-    {
-        auto & registry = ctx.reg;
-        auto const lock = std::scoped_lock{ctx};
-
-        registry.view<brun::position, brun::trail>().each([](auto const & p, auto & t) {
-            t.push_front(p);
-            t.pop_back();
-        });
+        return events;
     }
 } // namespace
 
@@ -214,10 +211,7 @@ void render_cycle(
     simulation_params const & params
 ) noexcept
 {
-    using namespace units::physical::si::literals;
-    auto const [days_per_second, fps, pts_per_day, _1, _2] = params;
-    auto const freq = fps * 1_q_s / 1_q_us;
-    auto const time_for_frame = std::chrono::microseconds{int((1./freq).count())}; // FIXME is this correct?
+    auto const [_0, fps, _1, _2, _3, _4, _5, _6, _7, _8] = params;
 
     // Init SDL graphics
     auto mgr = SDLpp::system_manager{SDLpp::flag::init::everything};
@@ -243,7 +237,13 @@ void render_cycle(
     // https://discourse.libsdl.org/t/mixing-opengl-and-renderer/19946/19
     auto gl_context = SDL_GL_GetCurrentContext();
     SDL_GL_MakeCurrent(window.handler(), gl_context);
-    SDL_GL_SetSwapInterval(1); // enable vsync
+    // Vsync alone would keep the display rate: it is enabled only when it is not faster than the frame rate
+    //  asked, and the pacer does the rest
+    auto mode = SDL_DisplayMode{};
+    auto const display = SDL_GetWindowDisplayIndex(window.handler());
+    auto const refresh_rate = display >= 0 and SDL_GetCurrentDisplayMode(display, &mode) == 0 ? mode.refresh_rate : 0;
+    auto const vsync = refresh_rate > 0 and fps.count() >= refresh_rate;
+    SDL_GL_SetSwapInterval(vsync ? 1 : 0);
 
     if (glewInit() != GLEW_OK) {
         fmt::print(stderr, "Failed to load OpenGL loader!\n");
@@ -252,20 +252,32 @@ void render_cycle(
 
     // Init Dear ImGUI
     [[maybe_unused]] auto & io = init_imgui(window, gl_context);
+    // Bodies and trails are drawn directly with OpenGL
+    auto scene = brun::gl_scene{};
 
     // Wait for the simulation
     while (ctx.status.load(std::memory_order::acquire) == brun::status::starting) {
         std::this_thread::yield();
     }
-    auto ctr = 0;
+    // The trails are sampled by the simulation: here they are only read
+    // With vsync a frame can't come before the next refresh: a faster pace would count every frame as dropped
+    auto pacer = brun::frame_pacer{vsync ? static_cast<double>(refresh_rate) : fps.count()};
+    auto ui_epoch = std::uint64_t{0};     // changes with every input
+    auto predictor = brun::trajectory_predictor{ctx};
     while (ctx.status.load(std::memory_order::acquire) == brun::status::running) {
-        io_events(ctx);
-        if (++ctr >= fps.count()/(days_per_second.count() * pts_per_day)) {
-            update_trail(ctx);
-            ctr = 0;
+        pacer.wait();
+        ui_epoch += io_events(ctx);
+        // Nobody would see a frame drawn in a minimized or hidden window
+        if ((SDL_GetWindowFlags(window.handler()) & (SDL_WINDOW_MINIMIZED | SDL_WINDOW_HIDDEN)) != 0) {
+            pacer.skip();
+            continue;
+        }
+        if (not draw_graphics(ctx, renderer, window, scene, pacer, predictor, ui_epoch)) {
+            pacer.skip();
         }
-        draw_graphics(ctx, renderer, window);
     }
+    pacer.histogram().dump(stdout);
+    fmt::print("Frames dropped: {}, skipped: {}\n", pacer.dropped(), pacer.skipped());
 
     // CleanUp
     ImGui_ImplOpenGL3_Shutdown();
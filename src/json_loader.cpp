@@ -0,0 +1,642 @@
+/**
+ * @author      : Riccardo Brugo (brugo.riccardo@gmail.com)
+ * @file        : json_loader
+ * @created     : Saturday Oct 17, 2026 11:23:44 CEST
+ * @license     : MIT
+ */
+
+#ifndef GRAVITY_NO_JSON
+
+#include "json_loader.hpp"
+#include "catalog.hpp"
+#include "generators.hpp"
+
+#include <map>
+#include <fstream>
+#include <algorithm>
+#include <utility>
+#include <limits>
+#include <optional>
+#include <tuple>
+#include <string_view>
+
+#include <nlohmann/json.hpp>
+
+#include <fmt/format.h>
+#include <fmt/ostream.h>
+
+namespace brun
+{
+
+namespace
+{
+    using json = nlohmann::json;
+
+    // How many bodies are collected before handing them to the sink
+    constexpr auto batch_size = std::size_t{4096};
+
+    // Builds a vector from the numbers read for an attribute
+    // As in the TOML files, a scalar `x` is a shorthand for (0, x, 0) if it is a distance and for
+    //  (x, 0, 0) if it is a velocity
+    template <typename Vector>
+    auto make_vector(std::vector<double> const & values)
+        -> std::optional<Vector>
+    {
+        using unit_type = typename Vector::value_type;
+        auto const zero = unit_type{0.};
+        if (values.size() == 1) {
+            auto const value = unit_type{values[0]};
+            if constexpr (std::is_same_v<Vector, brun::position>) {
+                return Vector{zero, value, zero};
+            } else {
+                return Vector{value, zero, zero};
+            }
+        }
+        if (values.size() == 3) {
+            return Vector{unit_type{values[0]}, unit_type{values[1]}, unit_type{values[2]}};
+        }
+        return std::nullopt;
+    }
+
+    // The content of the "config" table, with the same defaults of the TOML loader
+    struct config_values
+    {
+        int32_t trail_length  = 0;
+        float   trail_density = 5.f;
+        int32_t color         = 0xFFFFFF;
+        float   px_radius     = 5.f;
+    };
+    // The color of the bodies of a legacy scenario (a list of objects), which has no "config"
+    constexpr auto legacy_color = int32_t{0xFFFF00};
+
+    // A satellite given by orbital elements, with the satellites of its own which follow it: they can be
+    //  placed only when the mass of the object they orbit is known
+    struct pending_orbit
+    {
+        std::size_t first;
+        std::size_t count;
+        brun::orbital_elements elements;
+    };
+
+    // An object whose closing brace has not been read yet
+    struct object_frame
+    {
+        std::optional<std::string> name;
+        std::optional<std::string> parent;
+        std::optional<brun::orbital_elements> elements;
+        std::optional<double> mass;
+        std::vector<double> distance;
+        std::vector<double> velocity;
+        std::optional<double> trail_length;
+        std::optional<double> trail_density;
+        std::optional<double> color;
+        std::optional<double> px_radius;
+        std::vector<brun::body_record> satellites;  // completed satellites, relative to this object
+        std::vector<pending_orbit> pending;
+    };
+
+    // A reference to an external catalog, as it is being read
+    struct catalog_frame
+    {
+        std::string path;
+        std::string format;
+        std::string parent;
+        std::optional<double> trail_length;
+        std::optional<double> trail_density;
+        std::optional<double> color;
+        std::optional<double> px_radius;
+    };
+
+    // A [[belt]], [[ring]] or [[cluster]] block, as it is being read
+    struct generator_frame
+    {
+        std::string section;
+        std::map<std::string, double, std::less<>> numbers;
+        std::map<std::string, std::string, std::less<>> texts;
+    };
+
+    // Keeps track of where the parser is inside the document and builds the bodies on the fly
+    // Only the objects which are still open are kept in memory: a top level object is moved to the current
+    //  batch (together with its satellites) as soon as its closing brace is read
+    class scenario_handler : public nlohmann::json_sax<json>
+    {
+        enum class scope : uint8_t {
+            root, config, objects, object, satellites, vector, elements, catalogs, catalog,
+            generators, generator, includes, skip
+        };
+
+        std::filesystem::path const & _path;
+        brun::body_sink const & _sink;
+        brun::parent_lookup const & _find_parent;
+        brun::include_loader const & _load_includes;
+        std::vector<scope> _scopes;
+        std::vector<object_frame> _frames;
+        catalog_frame _catalog;
+        generator_frame _generator;
+        std::vector<std::filesystem::path> _includes;
+        std::vector<brun::body_record> _batch;
+        std::vector<double> * _vector = nullptr;   // the vector attribute being read
+        std::string _key;
+        config_values _config;
+        std::size_t _count = 0;
+
+        static constexpr auto is_distance(std::string_view const key) noexcept {
+            return key == "distance" or key == "distance_from_sun [e6 km]";
+        }
+        static constexpr auto is_velocity(std::string_view const key) noexcept {
+            return key == "orbital_velocity" or key == "orbital_velocity [km/s]";
+        }
+
+        void flush()
+        {
+            if (not _batch.empty()) {
+                _sink(std::exchange(_batch, {}));
+                _batch.reserve(batch_size);
+            }
+        }
+
+        void assign_config(double const value)
+        {
+            if (_key == "motion_trail_length") {
+                _config.trail_length = static_cast<int32_t>(value);
+            } else if (_key == "motion_trail_density") {
+                _config.trail_density = static_cast<float>(value);
+            } else if (_key == "default_color") {
+                _config.color = static_cast<int32_t>(value);
+            } else if (_key == "default_px_radius") {
+                _config.px_radius = static_cast<float>(value);
+                if (_config.px_radius < 0) {
+                    fmt::print(stderr, "Error - cannot use a negative value for the default px_radius\n");
+                    throw brun::load_error{8};
+                }
+            }
+        }
+
+        void assign_object(double const value)
+        {
+            auto & frame = _frames.back();
+            if (_key == "mass" or _key == "mass [Yg]") {
+                frame.mass = value;
+            } else if (is_distance(_key)) {
+                frame.distance = {value};
+            } else if (is_velocity(_key)) {
+                frame.velocity = {value};
+            } else if (_key == "motion_trail_length") {
+                frame.trail_length = value;
+            } else if (_key == "motion_trail_density") {
+                frame.trail_density = value;
+            } else if (_key == "color") {
+                frame.color = value;
+            } else if (_key == "px_radius") {
+                frame.px_radius = value;
+            }
+        }
+
+        void assign_elements(double const value)
+        {
+            auto & elements = *_frames.back().elements;
+            if (_key == "a") {
+                elements.a = value;
+            } else if (_key == "e") {
+                elements.e = value;
+            } else if (_key == "i") {
+                elements.i = value;
+            } else if (_key == "node") {
+                elements.node = value;
+            } else if (_key == "peri") {
+                elements.peri = value;
+            } else if (_key == "M") {
+                elements.mean_anomaly = value;
+            }
+        }
+
+        // Looks for a body among the ones not yet handed to the sink, then among the others
+        auto find_parent(std::string_view const name) const
+            -> std::optional<brun::orbital_parent>
+        {
+            auto const found = std::find_if(_batch.rbegin(), _batch.rend(), [name](auto const & body) {
+                return body.name == name;
+            });
+            if (found != _batch.rend()) {
+                return brun::orbital_parent{found->position, found->velocity, found->mass};
+            }
+            return _find_parent(name);
+        }
+
+        void assign_catalog(double const value)
+        {
+            if (_key == "motion_trail_length") {
+                _catalog.trail_length = value;
+            } else if (_key == "motion_trail_density") {
+                _catalog.trail_density = value;
+            } else if (_key == "color") {
+                _catalog.color = value;
+            } else if (_key == "px_radius") {
+                _catalog.px_radius = value;
+            }
+        }
+
+        // The attributes shared by all the bodies of a catalog or of a generator
+        auto make_defaults(
+            std::optional<double> const color, std::optional<double> const px_radius,
+            std::optional<double> const trail_length, std::optional<double> const trail_density,
+            std::string_view const what
+        ) const
+            -> brun::body_defaults
+        {
+            auto const radius = static_cast<float>(px_radius.value_or(_config.px_radius));
+            if (radius < 0) {
+                fmt::print(stderr, "Error - cannot use a negative value for the px_radius of {}\n", what);
+                throw brun::load_error{8};
+            }
+            auto const rgb = static_cast<int32_t>(color.value_or(_config.color));
+            auto const n = static_cast<int32_t>(trail_length.value_or(_config.trail_length));
+            auto const d = static_cast<int32_t>(trail_density.value_or(_config.trail_density));
+            return brun::body_defaults{
+                SDLpp::color{
+                    uint8_t((rgb & 0xFF0000) >> 16), uint8_t((rgb & 0x00FF00) >> 8), uint8_t(rgb & 0x0000FF)
+                },
+                radius,
+                std::max(n * d, 0)
+            };
+        }
+
+        // Catalogs are imported as soon as they are read, after the bodies which come before them
+        void close_catalog()
+        {
+            if (_catalog.path.empty()) {
+                fmt::print(stderr, "Error - every catalog needs a \"path\"\n");
+                throw brun::load_error{9};
+            }
+            auto const defaults = make_defaults(
+                _catalog.color, _catalog.px_radius, _catalog.trail_length, _catalog.trail_density,
+                fmt::format("catalog {}", _catalog.path)
+            );
+
+            auto catalog = brun::make_catalog_ref(_catalog.path, _catalog.format, defaults);
+            catalog.path = _path.parent_path() / catalog.path;  // catalog paths are relative to the scenario
+            catalog.parent = _catalog.parent;
+            if (catalog.kind == brun::catalog_ref::format::elements and catalog.parent.empty()) {
+                fmt::print(stderr, "Error - the catalog of orbital elements {} needs a \"parent\"\n", _catalog.path);
+                throw brun::load_error{10};
+            }
+
+            // Everything read so far goes to the sink first, so the parent can be found there
+            flush();
+            auto bodies = brun::import_catalog(catalog, _find_parent);
+            _count += bodies.size();
+            _sink(std::move(bodies));
+        }
+
+        // Generators are expanded as soon as they are read, like catalogs
+        void close_generator()
+        {
+            auto const find = [](auto const & map, std::string_view const key) {
+                auto const it = map.find(key);
+                return it != map.end() ? std::optional{it->second} : std::nullopt;
+            };
+            auto const & numbers = _generator.numbers;
+            auto const & texts   = _generator.texts;
+            auto const defaults = make_defaults(
+                find(numbers, "color"), find(numbers, "px_radius"),
+                find(numbers, "motion_trail_length"), find(numbers, "motion_trail_density"),
+                fmt::format("a \"{}\" block", _generator.section)
+            );
+            auto const spec = brun::make_generator(_generator.section,
+                [&](auto const key) { return find(numbers, key); },
+                [&](auto const key) { return find(texts, key); },
+                defaults
+            );
+
+            flush();
+            auto bodies = brun::expand_generator(spec, _find_parent);
+            _count += bodies.size();
+            _sink(std::move(bodies));
+        }
+
+        auto make_record(object_frame const & frame) const
+            -> brun::body_record
+        {
+            constexpr auto parse_error =
+                "Error while parsing {0} of {1}: "
+                "invalid content ({0} must be a scalar or a vector type of scalars with size 3)\n";
+            if (not frame.name.has_value()) {
+                fmt::print(stderr, "Error - found an object without a name in {}\n", _path);
+                throw brun::load_error{4};
+            }
+            auto const & name = *frame.name;
+            if (not frame.mass.has_value()) {
+                fmt::print(stderr, "no attribute \"mass\" found for {}\n", name);
+                throw brun::load_error{5};
+            }
+            // Objects given by orbital elements are placed by the caller
+            auto position = std::optional{brun::position{} * 0.};
+            auto velocity = std::optional{brun::velocity{} * 0.};
+            if (frame.elements.has_value()) {
+                if (auto const error = brun::check_elements(*frame.elements); error.has_value()) {
+                    fmt::print(stderr, "Error - invalid orbital elements for {}: {}\n", name, *error);
+                    throw brun::load_error{10};
+                }
+            } else {
+                position = make_vector<brun::position>(frame.distance);
+                velocity = make_vector<brun::velocity>(frame.velocity);
+            }
+            if (not position.has_value()) {
+                fmt::print(stderr, parse_error, "position", name);
+                throw brun::load_error{6};
+            }
+            if (not velocity.has_value()) {
+                fmt::print(stderr, parse_error, "velocity", name);
+                throw brun::load_error{7};
+            }
+            auto const px_radius = static_cast<float>(frame.px_radius.value_or(_config.px_radius));
+            if (px_radius < 0) {
+                fmt::print(stderr, "Error - cannot use a negative value for {} px_radius\n", name);
+                throw brun::load_error{8};
+            }
+            auto const color = static_cast<int32_t>(frame.color.value_or(_config.color));
+            auto const n = static_cast<int32_t>(frame.trail_length.value_or(_config.trail_length));
+            auto const d = static_cast<int32_t>(frame.trail_density.value_or(_config.trail_density));
+
+            return brun::body_record{
+                name,
+                brun::mass{*frame.mass},
+                *position,
+                *velocity,
+                SDLpp::color{
+                    uint8_t((color & 0xFF0000) >> 16), uint8_t((color & 0x00FF00) >> 8), uint8_t(color & 0x0000FF)
+                },
+                px_radius,
+                std::max(n * d, 0)
+            };
+        }
+
+        // The object on top of the stack is complete: its satellites are moved in the frame of its parent
+        //  (or in the frame of the system, if it has no parent)
+        void close_object()
+        {
+            auto frame = std::move(_frames.back());
+            _frames.pop_back();
+            auto record = make_record(frame);
+
+            // Now that the mass of this object is known, the satellites given by elements can be placed
+            auto const center = brun::orbital_parent{brun::position{} * 0., brun::velocity{} * 0., record.mass};
+            for (auto const & [first, count, elements] : frame.pending) {
+                auto const [position, velocity] = brun::orbit_state(elements, frame.satellites[first].mass, center);
+                for (auto k = first; k < first + count; ++k) {
+                    frame.satellites[k].position = frame.satellites[k].position + position;
+                    frame.satellites[k].velocity = frame.satellites[k].velocity + velocity;
+                }
+            }
+
+            // A top level object given by elements orbits a body which has already been read
+            if (frame.elements.has_value() and _frames.empty()) {
+                auto const parent = frame.parent.has_value() ? find_parent(*frame.parent) : std::nullopt;
+                if (not parent.has_value()) {
+                    fmt::print(stderr, "Error - can't find the parent of {}\n", record.name);
+                    throw brun::load_error{10};
+                }
+                std::tie(record.position, record.velocity) = brun::orbit_state(*frame.elements, record.mass, *parent);
+            }
+
+            auto const origin = record.position;
+            auto const drift  = record.velocity;
+            auto & destination = _frames.empty() ? _batch : _frames.back().satellites;
+            auto const first = destination.size();
+            destination.push_back(std::move(record));
+            for (auto & satellite : frame.satellites) {
+                satellite.position = satellite.position + origin;
+                satellite.velocity = satellite.velocity + drift;
+                destination.push_back(std::move(satellite));
+            }
+            if (frame.elements.has_value() and not _frames.empty()) {
+                _frames.back().pending.push_back({first, frame.satellites.size() + 1, *frame.elements});
+            }
+            _count += frame.satellites.size() + 1;
+
+            if (_frames.empty() and _batch.size() >= batch_size) {
+                flush();
+            }
+        }
+
+        auto number(double const value)
+        {
+            if (_scopes.empty()) {
+                return true;
+            }
+            switch (_scopes.back()) {
+            case scope::config:
+                assign_config(value);
+                break;
+            case scope::object:
+                assign_object(value);
+                break;
+            case scope::vector:
+                _vector->push_back(value);
+                break;
+            case scope::elements:
+                assign_elements(value);
+                break;
+            case scope::catalog:
+                assign_catalog(value);
+                break;
+            case scope::generator:
+                _generator.numbers.insert_or_assign(_key, value);
+                break;
+            default:
+                break;
+            }
+            return true;
+        }
+
+    public:
+        scenario_handler(
+            std::filesystem::path const & path, brun::body_sink const & sink,
+            brun::parent_lookup const & find_parent, brun::include_loader const & load_includes
+        )
+            : _path{path}, _sink{sink}, _find_parent{find_parent}, _load_includes{load_includes}
+        {
+            _batch.reserve(batch_size);
+        }
+
+        void finish() { flush(); }
+        auto count()         const noexcept { return _count; }
+        auto trail_density() const noexcept { return _config.trail_density; }
+
+        bool null() override                                           { return true; }
+        bool boolean(bool) override                                    { return true; }
+        bool binary(binary_t &) override                               { return true; }
+        bool number_integer(number_integer_t const value) override     { return number(static_cast<double>(value)); }
+        bool number_unsigned(number_unsigned_t const value) override   { return number(static_cast<double>(value)); }
+        bool number_float(number_float_t const value, string_t const &) override { return number(value); }
+
+        bool string(string_t & value) override
+        {
+            if (_scopes.empty()) {
+                return true;
+            }
+            if (_scopes.back() == scope::object and _key == "name") {
+                _frames.back().name = std::move(value);
+            } else if (_scopes.back() == scope::object and _key == "parent") {
+                _frames.back().parent = std::move(value);
+            } else if (_scopes.back() == scope::catalog and _key == "parent") {
+                _catalog.parent = std::move(value);
+            } else if (_scopes.back() == scope::catalog and _key == "path") {
+                _catalog.path = std::move(value);
+            } else if (_scopes.back() == scope::catalog and _key == "format") {
+                _catalog.format = std::move(value);
+            } else if (_scopes.back() == scope::generator) {
+                _generator.texts.insert_or_assign(_key, std::move(value));
+            } else if (_scopes.back() == scope::includes) {
+                _includes.push_back(_path.parent_path() / value);
+            }
+            return true;
+        }
+
+        bool key(string_t & value) override
+        {
+            _key = std::move(value);
+            return true;
+        }
+
+        bool start_object(std::size_t) override
+        {
+            if (_scopes.empty()) {
+                _scopes.push_back(scope::root);
+                return true;
+            }
+            switch (_scopes.back()) {
+            case scope::root:
+                if (_key == "config" and _count > 0) {
+                    fmt::print(stderr, "Warning - \"config\" found after some objects in {}: "
+                                       "it will be applied only to the following ones\n", _path);
+                }
+                _scopes.push_back(_key == "config" ? scope::config : scope::skip);
+                break;
+            case scope::objects:
+            case scope::satellites:
+                _frames.emplace_back();
+                _scopes.push_back(scope::object);
+                break;
+            case scope::object:
+                if (_key == "elements") {
+                    constexpr auto missing = std::numeric_limits<double>::quiet_NaN();
+                    _frames.back().elements = brun::orbital_elements{missing, 0., 0., 0., 0., 0.};
+                    _scopes.push_back(scope::elements);
+                } else {
+                    _scopes.push_back(scope::skip);
+                }
+                break;
+            case scope::catalogs:
+                _catalog = catalog_frame{};
+                _scopes.push_back(scope::catalog);
+                break;
+            case scope::generators:
+                _generator.numbers.clear();
+                _generator.texts.clear();
+                _scopes.push_back(scope::generator);
+                break;
+            default:
+                _scopes.push_back(scope::skip);
+                break;
+            }
+            return true;
+        }
+
+        bool end_object() override
+        {
+            auto const closed = _scopes.back();
+            _scopes.pop_back();
+            if (closed == scope::object) {
+                close_object();
+            } else if (closed == scope::catalog) {
+                close_catalog();
+            } else if (closed == scope::generator) {
+                close_generator();
+            }
+            return true;
+        }
+
+        bool start_array(std::size_t) override
+        {
+            // Legacy format: the document is a list of objects
+            if (_scopes.empty()) {
+                _config.color = legacy_color;
+                _scopes.push_back(scope::objects);
+                return true;
+            }
+            auto const current = _scopes.back();
+            if (current == scope::root and _key == "object") {
+                _scopes.push_back(scope::objects);
+            } else if (current == scope::root and _key == "catalog") {
+                _scopes.push_back(scope::catalogs);
+            } else if (current == scope::root and (_key == "belt" or _key == "ring" or _key == "cluster")) {
+                _generator.section = _key;
+                _scopes.push_back(scope::generators);
+            } else if (current == scope::root and _key == "include") {
+                _includes.clear();
+                _scopes.push_back(scope::includes);
+            } else if (current == scope::object and _key == "satellites") {
+                _scopes.push_back(scope::satellites);
+            } else if (current == scope::object and (is_distance(_key) or is_velocity(_key))) {
+                auto & frame = _frames.back();
+                _vector = is_distance(_key) ? &frame.distance : &frame.velocity;
+                _vector->clear();
+                _scopes.push_back(scope::vector);
+            } else {
+                _scopes.push_back(scope::skip);
+            }
+            return true;
+        }
+
+        bool end_array() override
+        {
+            if (_scopes.back() == scope::vector) {
+                _vector = nullptr;
+            } else if (_scopes.back() == scope::includes) {
+                // The included bodies come after the ones read so far
+                flush();
+                _load_includes(_includes);
+            }
+            _scopes.pop_back();
+            return true;
+        }
+
+        bool parse_error(std::size_t const position, std::string const &,
+                         nlohmann::detail::exception const & ex) override
+        {
+            fmt::print(stderr, "Error while parsing {} (byte {}): {}\n", _path, position, ex.what());
+            return false;
+        }
+    };
+} // namespace
+
+auto stream_json(
+    std::filesystem::path const & data_path, body_sink const & sink, parent_lookup const & find_parent,
+    include_loader const & load_includes
+)
+    -> float
+{
+    if (not std::filesystem::exists(data_path)) {
+        fmt::print(stderr, "Error - can't find file {}\n", data_path);
+        throw brun::load_error{1};
+    }
+    auto file = std::ifstream{data_path};
+    if (not file.is_open()) {
+        fmt::print(stderr, "Error - can't open file {}\n", data_path);
+        throw brun::load_error{2};
+    }
+
+    auto handler = scenario_handler{data_path, sink, find_parent, load_includes};
+    if (not json::sax_parse(file, &handler)) {
+        throw brun::load_error{4};
+    }
+    handler.finish();
+    fmt::print("Registered {} objects from {}\n", handler.count(), data_path);
+    return handler.trail_density();
+}
+
+} // namespace brun
+
+#endif // GRAVITY_NO_JSON
+
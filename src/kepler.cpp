@@ -0,0 +1,164 @@
+/**
+ * @author      : Riccardo Brugo (brugo.riccardo@gmail.com)
+ * @file        : kepler
+ * @created     : Saturday Oct 17, 2026 13:04:37 CEST
+ * @license     : MIT
+ */
+
+#include "kepler.hpp"
+#include "simulation.hpp"
+
+#include <array>
+#include <cmath>
+#include <memory>
+#include <numbers>
+#include <numeric>
+#include <algorithm>
+#include <execution>                 // for parallelism    (std::execution::par)
+
+namespace brun
+{
+
+namespace
+{
+    constexpr auto block_size = std::size_t{512};
+    constexpr auto newton_iterations = 12;
+    constexpr auto deg = std::numbers::pi / 180.;
+    constexpr auto two_pi = 2. * std::numbers::pi;
+
+    // A block of bodies, as a structure of arrays
+    // Inputs are in Gm, radians and Gm³/s²; outputs in Gm and km/s, relative to the parent
+    struct block
+    {
+        using column = std::array<double, block_size>;
+        column a, e, i, node, peri, M, mu;
+        column x, y, z, vx, vy, vz;
+    };
+
+    void solve_block(block & b, std::size_t const n) noexcept
+    {
+        auto E = block::column{};
+
+        // Kepler's equation, M = E - e·sin(E)
+        // Starting from E = π Newton's method converges for every M and e < 1; for low eccentricities
+        //  E = M is a better guess
+        for (auto k = 0ul; k < n; ++k) {
+            b.M[k] -= two_pi * std::floor(b.M[k] / two_pi);
+            E[k] = b.e[k] < 0.8 ? b.M[k] : std::numbers::pi;
+        }
+        for (auto iteration = 0; iteration < newton_iterations; ++iteration) {
+            for (auto k = 0ul; k < n; ++k) {
+                auto const f  = E[k] - b.e[k] * std::sin(E[k]) - b.M[k];
+                auto const df = 1. - b.e[k] * std::cos(E[k]);
+                E[k] -= f / df;
+            }
+        }
+
+        // From the perifocal frame to the x-y frame
+        for (auto k = 0ul; k < n; ++k) {
+            auto const cos_E = std::cos(E[k]), sin_E = std::sin(E[k]);
+            auto const root  = std::sqrt(1. - b.e[k] * b.e[k]);
+            auto const mean_motion = std::sqrt(b.mu[k] / (b.a[k] * b.a[k] * b.a[k]));
+            auto const speed = b.a[k] * mean_motion / (1. - b.e[k] * cos_E) * 1e6;  // Gm/s -> km/s
+
+            auto const xp  = b.a[k] * (cos_E - b.e[k]);
+            auto const yp  = b.a[k] * root * sin_E;
+            auto const vxp = -speed * sin_E;
+            auto const vyp = speed * root * cos_E;
+
+            auto const cos_O = std::cos(b.node[k]), sin_O = std::sin(b.node[k]);
+            auto const cos_w = std::cos(b.peri[k]), sin_w = std::sin(b.peri[k]);
+            auto const cos_i = std::cos(b.i[k]),    sin_i = std::sin(b.i[k]);
+            auto const px =  cos_O * cos_w - sin_O * sin_w * cos_i;
+            auto const py =  sin_O * cos_w + cos_O * sin_w * cos_i;
+            auto const pz =  sin_w * sin_i;
+            auto const qx = -cos_O * sin_w - sin_O * cos_w * cos_i;
+            auto const qy = -sin_O * sin_w + cos_O * cos_w * cos_i;
+            auto const qz =  cos_w * sin_i;
+
+            b.x[k]  = xp  * px + yp  * qx;
+            b.y[k]  = xp  * py + yp  * qy;
+            b.z[k]  = xp  * pz + yp  * qz;
+            b.vx[k] = vxp * px + vyp * qx;
+            b.vy[k] = vxp * py + vyp * qy;
+            b.vz[k] = vxp * pz + vyp * qz;
+        }
+    }
+} // namespace
+
+auto check_elements(orbital_elements const & elements) noexcept
+    -> std::optional<std::string_view>
+{
+    if (not (elements.a > 0)) {
+        return "the semi-major axis must be positive";
+    }
+    if (not (elements.e >= 0 and elements.e < 1)) {
+        return "the eccentricity must be in [0, 1)";
+    }
+    return std::nullopt;
+}
+
+void place_on_orbits(
+    std::span<brun::body_record> bodies, std::span<orbital_elements const> elements, orbital_parent const & parent
+)
+{
+    // G·M, from m³/s² with M in kg to Gm³/s² with M in Yg
+    constexpr auto G = brun::constants::G<>.count() * 1e21 / 1e27;
+
+    auto blocks = std::vector<std::size_t>((bodies.size() + block_size - 1) / block_size);
+    std::iota(blocks.begin(), blocks.end(), 0ul);
+    std::for_each(std::execution::par, blocks.begin(), blocks.end(), [&](auto const index) {
+        auto const first = index * block_size;
+        auto const n = std::min(block_size, bodies.size() - first);
+        auto b = std::make_unique<block>();
+        for (auto k = 0ul; k < n; ++k) {
+            auto const & el = elements[first + k];
+            b->a[k]    = el.a;
+            b->e[k]    = el.e;
+            b->i[k]    = el.i * deg;
+            b->node[k] = el.node * deg;
+            b->peri[k] = el.peri * deg;
+            b->M[k]    = el.mean_anomaly * deg;
+            b->mu[k]   = G * (parent.mass + bodies[first + k].mass).count();
+        }
+
+        solve_block(*b, n);
+
+        using brun::position_scalar;
+        using brun::velocity_scalar;
+        for (auto k = 0ul; k < n; ++k) {
+            auto & body = bodies[first + k];
+            body.position = parent.position + brun::position{
+                position_scalar{b->x[k]}, position_scalar{b->y[k]}, position_scalar{b->z[k]}
+            };
+            body.velocity = parent.velocity + brun::velocity{
+                velocity_scalar{b->vx[k]}, velocity_scalar{b->vy[k]}, velocity_scalar{b->vz[k]}
+            };
+        }
+    });
+}
+
+auto orbit_state(orbital_elements const & elements, brun::mass const mass, orbital_parent const & parent)
+    -> std::pair<brun::position, brun::velocity>
+{
+    auto body = brun::body_record{};
+    body.mass = mass;
+    place_on_orbits(std::span{&body, 1}, std::span{&elements, 1}, parent);
+    return std::pair{body.position, body.velocity};
+}
+
+auto find_orbital_parent(entt::registry const & registry, std::string_view const name)
+    -> std::optional<brun::orbital_parent>
+{
+    auto const view = registry.view<brun::tag const, brun::position const, brun::velocity const, brun::mass const>();
+    for (auto const entt : view) {
+        if (view.get<brun::tag const>(entt) == name) {
+            auto const [position, velocity, mass] = view.get<brun::position const, brun::velocity const, brun::mass const>(entt);
+            return brun::orbital_parent{position, velocity, mass};
+        }
+    }
+    return std::nullopt;
+}
+
+} // namespace brun
+
@@ -8,13 +8,34 @@
 #include "simulation.hpp"
 #include "config.hpp"                // for "config" file related functions
 #include "io.hpp"                    // graphics related functions
+#include "recorder.hpp"              // offscreen rendering (brun::record_cycle)
 #include "cli.hpp"                   // for `parse_cli` function (uses Lyra)
+#include "reload.hpp"                // for hot reload     (brun::scenario_reloader)
+#include "injector.hpp"              // for live bodies    (brun::body_injector)
+#include "trail.hpp"                 // for motion trails  (brun::set_trail_policy)
 
+#include <atomic>
 #include <csignal>                   // signal handling    (std::signal)
 #include <thread>                    // for multithreading (std::jthread)
+#include <memory>                    // for std::unique_ptr
+#include <filesystem>
 
 #include <fmt/format.h>              // formatting         (fmt::print, fmt::format)
 
+namespace
+{
+    // SIGINT stops the threads through the status of the context, so that they end as they always do (e.g.
+    //  the renderer prints its frame times); a second one ends the program at once
+    std::atomic<brun::status> * status = nullptr;
+    static_assert(std::atomic<brun::status>::is_always_lock_free, "the status is written by a signal handler");
+
+    void interrupt(int) noexcept
+    {
+        status->store(brun::status::stopped, std::memory_order::release);
+        std::signal(SIGINT, SIG_DFL);
+    }
+} // namespace
+
 // The program entry point
 int main(int argc, char const * argv[])
 {
@@ -27,12 +48,16 @@ int main(int argc, char const * argv[])
         }
         std::exit(0);
     }
-    auto const [days_per_second, fps, points_per_day, view_radius, filename] = *params;
+    auto const [days_per_second, fps, points_per_day, view_radius, filename, watch, inject, trail_tolerance, trail_budget, record] = *params;
     fmt::print("dps: {}\nfps: {}\nview radius: {}\nfilename: {}\n", days_per_second, fps, view_radius, filename);
-    std::signal(SIGINT, &std::exit);
 
     auto ctx = brun::context{};
-    std::tie(ctx.reg, params->points_per_day) = brun::load_data(not filename.empty() ? filename : "../planets.toml"); // Registry is loaded from file
+    status = &ctx.status;
+    std::signal(SIGINT, &interrupt);
+    auto const path = std::filesystem::path{not filename.empty() ? filename : "../planets.toml"};
+    auto files = std::vector<std::filesystem::path>{};
+    std::tie(ctx.reg, params->points_per_day) = brun::load_data(path, &files); // Registry is loaded from file
+    brun::set_trail_policy(ctx.reg, brun::trail::policy{trail_tolerance, trail_budget});
     ctx.view_radius = view_radius;
     ctx.min_max_view_radius.second = [&ctx, view_radius]() {
         auto const entities = ctx.reg.view<brun::position const>();
@@ -43,12 +68,17 @@ int main(int argc, char const * argv[])
         return std::max(*std::ranges::max_element(positions), view_radius);
     }();
 
+    // Changes to the scenario file are applied while the simulation runs
+    auto reloader = watch ? std::make_unique<brun::scenario_reloader>(ctx, std::move(files)) : nullptr;
+    // New bodies can be added by other processes
+    auto injector = not inject.empty() ? std::make_unique<brun::body_injector>(ctx, inject) : nullptr;
+
     // Creates a thread dedicated to simulation
-    auto worker = std::jthread{brun::simulation, std::ref(ctx), days_per_second};
-    // Creates a thread dedicated to IO operations
-    auto io = fps.count() > 0
-              ? std::jthread{brun::render_cycle, std::ref(ctx), std::cref(*params)}
-              : std::jthread{};
+    auto worker = std::jthread{brun::simulation, std::ref(ctx), days_per_second, params->points_per_day};
+    // Creates a thread dedicated to IO operations: a window, or frames written to files
+    auto io = not record.path.empty() ? std::jthread{brun::record_cycle, std::ref(ctx), std::cref(*params)}
+            : fps.count() > 0         ? std::jthread{brun::render_cycle, std::ref(ctx), std::cref(*params)}
+            :                           std::jthread{};
 
     return 0;
 }
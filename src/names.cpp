@@ -0,0 +1,162 @@
+/**
+ * @author      : Riccardo Brugo (brugo.riccardo@gmail.com)
+ * @file        : names
+ * @created     : Saturday Oct 17, 2026 21:52:10 CEST
+ * @license     : MIT
+ */
+
+#include "names.hpp"
+
+#include <mutex>
+#include <memory>
+#include <cstring>
+#include <numeric>
+#include <algorithm>
+#include <unordered_set>
+
+namespace brun
+{
+
+namespace
+{
+    // The strings are copied in blocks, one after the other, each one with its null terminator
+    constexpr auto block_size = std::size_t{1} << 16;
+
+    struct string_pool
+    {
+        std::mutex mtx;
+        std::vector<std::unique_ptr<char[]>> blocks;
+        std::size_t used = block_size;
+        std::unordered_set<std::string_view> strings;
+
+        auto store(std::string_view const s)
+            -> std::string_view
+        {
+            auto const needed = s.size() + 1;
+            if (needed > block_size) {
+                // A name longer than a block gets one of its own
+                auto & block = blocks.emplace_back(std::make_unique<char[]>(needed));
+                std::memcpy(block.get(), s.data(), s.size());
+                used = block_size;
+                return {block.get(), s.size()};
+            }
+            if (used + needed > block_size) {
+                blocks.push_back(std::make_unique<char[]>(block_size));
+                used = 0;
+            }
+            auto * const first = blocks.back().get() + used;
+            std::memcpy(first, s.data(), s.size());
+            first[s.size()] = '\0';
+            used += needed;
+            return {first, s.size()};
+        }
+    };
+
+    auto lower(char const c) noexcept
+    {
+        return c >= 'A' and c <= 'Z' ? static_cast<char>(c - 'A' + 'a') : c;
+    }
+
+    // Orders the names without regard to case; equal ones by their case
+    auto less(std::string_view const a, std::string_view const b) noexcept
+    {
+        auto const n = std::min(a.size(), b.size());
+        for (auto i = 0ul; i < n; ++i) {
+            if (auto const x = lower(a[i]), y = lower(b[i]); x != y) {
+                return x < y;
+            }
+        }
+        return a.size() != b.size() ? a.size() < b.size() : a < b;
+    }
+
+    auto starts_with(std::string_view const name, std::string_view const prefix) noexcept
+    {
+        return name.size() >= prefix.size()
+           and std::equal(prefix.begin(), prefix.end(), name.begin(), [](auto const x, auto const y) {
+                   return lower(x) == lower(y);
+               });
+    }
+
+    // How far apart the letters of `query` are found in `name`, in order; -1 if they are not all there
+    auto spread(std::string_view const name, std::string_view const query) noexcept
+        -> std::ptrdiff_t
+    {
+        auto first = std::string_view::npos;
+        auto k = 0ul;
+        for (auto i = 0ul; i < name.size() and k < query.size(); ++i) {
+            if (lower(name[i]) == lower(query[k])) {
+                first = k == 0 ? i : first;
+                if (++k == query.size()) {
+                    return static_cast<std::ptrdiff_t>(i - first);
+                }
+            }
+        }
+        return -1;
+    }
+} // namespace
+
+auto intern(std::string_view const name)
+    -> std::string_view
+{
+    static auto pool = string_pool{};
+    auto const _ = std::lock_guard{pool.mtx};
+    if (auto const found = pool.strings.find(name); found != pool.strings.end()) {
+        return *found;
+    }
+    auto const stored = pool.store(name);
+    pool.strings.insert(stored);
+    return stored;
+}
+
+void name_index::add(entt::registry const & registry, std::span<entt::entity const> entities)
+{
+    // The new names are sorted on their own, then merged with the others
+    auto const old_size = _entries.size();
+    _entries.reserve(old_size + entities.size());
+    for (auto const entt : entities) {
+        _entries.push_back({registry.get<brun::tag>(entt), entt});
+    }
+    auto const by_name = [](entry const & a, entry const & b) { return less(a.name, b.name); };
+    auto const middle = _entries.begin() + static_cast<std::ptrdiff_t>(old_size);
+    std::sort(middle, _entries.end(), by_name);
+    std::inplace_merge(_entries.begin(), middle, _entries.end(), by_name);
+}
+
+void name_index::remove(std::span<entt::entity const> entities)
+{
+    auto const removed = std::unordered_set<entt::entity>{entities.begin(), entities.end()};
+    std::erase_if(_entries, [&removed](entry const & e) { return removed.contains(e.entity); });
+}
+
+auto name_index::search(std::string_view const query, std::size_t const limit) const
+    -> std::vector<entt::entity>
+{
+    auto res = std::vector<entt::entity>{};
+    // The names starting with the query are all together
+    auto const first = std::ranges::partition_point(_entries, [query](entry const & e) {
+        return less(e.name, query) and not starts_with(e.name, query);
+    });
+    for (auto it = first; it != _entries.end() and res.size() < limit and starts_with(it->name, query); ++it) {
+        res.push_back(it->entity);
+    }
+    if (res.size() == limit or query.empty()) {
+        return res;
+    }
+
+    // Then the others, scanning all of them
+    auto matches = std::vector<std::pair<std::ptrdiff_t, std::size_t>>{};
+    for (auto i = 0ul; i < _entries.size(); ++i) {
+        auto const name = _entries[i].name.view();
+        if (auto const d = spread(name, query); d >= 0 and not starts_with(name, query)) {
+            matches.emplace_back(d, i);
+        }
+    }
+    auto const n = std::min(limit - res.size(), matches.size());
+    std::partial_sort(matches.begin(), matches.begin() + static_cast<std::ptrdiff_t>(n), matches.end());
+    for (auto k = 0ul; k < n; ++k) {
+        res.push_back(_entries[matches[k].second].entity);
+    }
+    return res;
+}
+
+} // namespace brun
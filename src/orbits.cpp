@@ -0,0 +1,244 @@
+/**
+ * @author      : Riccardo Brugo (brugo.riccardo@gmail.com)
+ * @file        : orbits
+ * @created     : Sunday Oct 18, 2026 01:06:52 CEST
+ * @license     : MIT
+ */
+
+#include "orbits.hpp"
+#include "trail.hpp"
+
+#include <cmath>
+#include <limits>
+#include <numbers>
+#include <algorithm>
+#include <execution>                 // for parallelism    (std::execution::par)
+
+namespace brun
+{
+
+namespace
+{
+    // Parents are looked for only among this many bodies, so that the batch is linear in the bodies
+    constexpr auto max_parents = std::size_t{64};
+    // G, with masses in Yg and distances in Gm [Gm³/(Yg·s²)]
+    constexpr auto G = brun::constants::G<>.count() * 1e21 / 1e27;
+    constexpr auto none = std::numeric_limits<std::size_t>::max();
+    // An orbit is first cut in this many pieces, then every piece in two at most `max_depth` times
+    constexpr auto initial_pieces = 16;
+    constexpr auto max_depth = 6;
+
+    using vec3 = std::array<double, 3>;
+
+    auto to_vec3(auto const & v) noexcept -> vec3 { return {v[0].count(), v[1].count(), v[2].count()}; }
+    auto dot(vec3 const & a, vec3 const & b) noexcept { return a[0] * b[0] + a[1] * b[1] + a[2] * b[2]; }
+    auto length(vec3 const & a) noexcept { return std::sqrt(dot(a, a)); }
+    auto cross(vec3 const & a, vec3 const & b) noexcept -> vec3
+    {
+        return {a[1] * b[2] - a[2] * b[1], a[2] * b[0] - a[0] * b[2], a[0] * b[1] - a[1] * b[0]};
+    }
+
+    struct primary
+    {
+        entt::entity entt;
+        vec3 r;         // [Gm]
+        vec3 v;         // [km/s]
+        double mass;    // [Yg]
+        double soi;     // radius of the sphere of influence [Gm]
+    };
+
+    // The lightest of the primaries (sorted from the heaviest) heavier than `mass` whose sphere of influence
+    //  holds `r`
+    auto find_parent(std::span<primary const> const primaries, vec3 const & r, double const mass) noexcept
+    {
+        auto best = none;
+        for (auto k = 0ul; k < primaries.size() and primaries[k].mass > mass; ++k) {
+            auto const & candidate = primaries[k];
+            auto const d = vec3{r[0] - candidate.r[0], r[1] - candidate.r[1], r[2] - candidate.r[2]};
+            if (length(d) < candidate.soi and (best == none or candidate.soi < primaries[best].soi)) {
+                best = k;
+            }
+        }
+        return best;
+    }
+
+    // The osculating orbit from the state relative to the parent; `a` is 0 when the body is not bound
+    auto osculate(vec3 const & r, vec3 v, double const mu, double const soi) noexcept
+        -> brun::osculating_orbit
+    {
+        auto res = brun::osculating_orbit{};
+        res.a = 0.;
+        for (auto & c : v) {
+            c *= 1e-6;  // km/s -> Gm/s
+        }
+        auto const distance = length(r);
+        auto const energy = dot(v, v) * 0.5 - mu / distance;
+        auto const h = cross(r, v);
+        auto const momentum = length(h);
+        if (not (distance > 0. and energy < 0. and momentum > 0.)) {
+            return res;
+        }
+        auto const a = -mu / (2. * energy);
+        auto const vh = cross(v, h);
+        auto const e_vec = vec3{vh[0] / mu - r[0] / distance, vh[1] / mu - r[1] / distance, vh[2] / mu - r[2] / distance};
+        auto const e = length(e_vec);
+        if (e >= 1. or a * (1. + e) > soi) {
+            return res;
+        }
+        // A circular orbit has no periapsis: any point will do
+        auto const & axis = e > 1e-9 ? e_vec : r;
+        auto const norm = e > 1e-9 ? e : distance;
+        res.p = {axis[0] / norm, axis[1] / norm, axis[2] / norm};
+        res.q = cross({h[0] / momentum, h[1] / momentum, h[2] / momentum}, res.p);
+        res.a = a;
+        res.e = e;
+        return res;
+    }
+
+    struct screen_point { float x, y, distance2; };
+
+    auto project_point(brun::projection const & view, brun::position const & point) noexcept
+    {
+        auto const & [r0, r1, r2] = view.m;
+        auto const px = point[0].count(), py = point[1].count(), pz = point[2].count();
+        auto const u = r0[0] * px + r0[1] * py + r0[2] * pz + r0[3];
+        auto const v = r1[0] * px + r1[1] * py + r1[2] * pz + r1[3];
+        auto const w = r2[0] * px + r2[1] * py + r2[2] * pz + r2[3];
+        return screen_point{
+            static_cast<float>(u) + view.center_x, static_cast<float>(v) + view.center_y,
+            static_cast<float>(u * u + v * v + w * w)
+        };
+    }
+
+    // Appends the points after `p0` up to `p1`, splitting the piece while its middle is too far from the chord
+    template <typename Project>
+    void refine(
+        Project const & project, double const E0, screen_point const & p0, double const E1, screen_point const & p1,
+        float const tolerance, int const depth, brun::projected_points & out
+    )
+    {
+        auto const Em = (E0 + E1) * 0.5;
+        auto const pm = project(Em);
+        auto const dx = pm.x - (p0.x + p1.x) * 0.5f, dy = pm.y - (p0.y + p1.y) * 0.5f;
+        if (depth < max_depth and dx * dx + dy * dy > tolerance * tolerance) {
+            refine(project, E0, p0, Em, pm, tolerance, depth + 1, out);
+            refine(project, Em, pm, E1, p1, tolerance, depth + 1, out);
+            return;
+        }
+        out.x.push_back(p1.x);
+        out.y.push_back(p1.y);
+        out.distance2.push_back(p1.distance2);
+    }
+} // namespace
+
+auto osculating_orbit::at(double const E) const noexcept
+    -> brun::position
+{
+    auto const x = a * (std::cos(E) - e);
+    auto const y = a * std::sqrt(1. - e * e) * std::sin(E);
+    return brun::position{
+        brun::position_scalar{x * p[0] + y * q[0]},
+        brun::position_scalar{x * p[1] + y * q[1]},
+        brun::position_scalar{x * p[2] + y * q[2]}
+    };
+}
+
+void compute_orbits(entt::registry const & registry, std::vector<brun::osculating_orbit> & out)
+{
+    auto primaries = std::vector<primary>{};
+    registry.view<brun::position const, brun::velocity const, brun::mass const>().each(
+        [&primaries](auto const entt, auto const & r, auto const & v, auto const mass) {
+            if (mass.count() > 0) {
+                primaries.push_back({entt, to_vec3(r), to_vec3(v), mass.count(), 0.});
+            }
+        }
+    );
+    auto const heavier = [](primary const & lhs, primary const & rhs) { return lhs.mass > rhs.mass; };
+    auto const kept = std::min(primaries.size(), max_parents);
+    std::ranges::partial_sort(primaries, primaries.begin() + static_cast<std::ptrdiff_t>(kept), heavier);
+    primaries.resize(kept);
+
+    // The spheres of influence, from the heaviest body down: the heaviest one holds everything
+    for (auto i = 0ul; i < primaries.size(); ++i) {
+        auto & body = primaries[i];
+        auto const parent = find_parent(std::span{primaries}.first(i), body.r, body.mass);
+        if (parent == none) {
+            body.soi = std::numeric_limits<double>::infinity();
+            continue;
+        }
+        auto const & p = primaries[parent];
+        auto const d = vec3{body.r[0] - p.r[0], body.r[1] - p.r[1], body.r[2] - p.r[2]};
+        body.soi = length(d) * std::pow(body.mass / p.mass, 0.4);
+    }
+
+    auto const view = registry.view<brun::trail const, brun::position const, brun::velocity const, brun::mass const>();
+    auto bodies = std::vector<entt::entity>(view.begin(), view.end());
+    out.resize(bodies.size());
+    std::transform(std::execution::par, bodies.begin(), bodies.end(), out.begin(), [&](auto const entt) {
+        auto const [position, velocity, mass] = view.get<brun::position const, brun::velocity const, brun::mass const>(entt);
+        auto const r = to_vec3(position);
+        auto const parent = find_parent(primaries, r, mass.count());
+        if (parent == none) {
+            return brun::osculating_orbit{entt, entt, 0., 0., {}, {}};
+        }
+        auto const & p = primaries[parent];
+        auto const v = to_vec3(velocity);
+        auto orbit = osculate(
+            {r[0] - p.r[0], r[1] - p.r[1], r[2] - p.r[2]}, {v[0] - p.v[0], v[1] - p.v[1], v[2] - p.v[2]},
+            G * (p.mass + mass.count()), p.soi
+        );
+        orbit.body = entt;
+        orbit.parent = p.entt;
+        return orbit;
+    });
+    std::erase_if(out, [](auto const & orbit) { return orbit.a == 0.; });
+}
+
+void trace_orbit(
+    brun::osculating_orbit const & orbit, brun::position const & focus, brun::projection const & view,
+    float const tolerance, brun::projected_points & out
+)
+{
+    constexpr auto two_pi = 2. * std::numbers::pi;
+    auto const project = [&](double const E) { return project_point(view, focus + orbit.at(E)); };
+    auto E0 = 0.;
+    auto p0 = project(E0);
+    out.x.push_back(p0.x);
+    out.y.push_back(p0.y);
+    out.distance2.push_back(p0.distance2);
+    for (auto i = 1; i <= initial_pieces; ++i) {
+        // The last point is the first one, so that the polyline closes exactly
+        auto const E1 = i == initial_pieces ? two_pi : two_pi * i / initial_pieces;
+        auto const p1 = i == initial_pieces ? project(0.) : project(E1);
+        refine(project, E0, p0, E1, p1, tolerance, 0, out);
+        E0 = E1;
+        p0 = p1;
+    }
+}
+
+void park_trails(entt::registry & registry, std::span<entt::entity const> const bound)
+{
+    // Trails are given back first, and only then parked: the bodies which stay bound are left as they are
+    auto released = std::vector<entt::entity>{};
+    registry.view<brun::parked_trail const, brun::trail>().each(
+        [&](auto const entt, auto const & parked, auto & trail) {
+            if (not std::ranges::binary_search(bound, entt)) {
+                trail.resize(parked.length);
+                released.push_back(entt);
+            }
+        }
+    );
+    registry.remove<brun::parked_trail>(released.begin(), released.end());
+
+    for (auto const entt : bound) {
+        if (not registry.valid(entt) or registry.has<brun::parked_trail>(entt)) {
+            continue;
+        }
+        if (auto * trail = registry.try_get<brun::trail>(entt); trail != nullptr) {
+            registry.emplace<brun::parked_trail>(entt, trail->length());
+            trail->resize(1);
+        }
+    }
+}
+
+} // namespace brun
@@ -0,0 +1,98 @@
+/**
+ * @author      : Riccardo Brugo (brugo.riccardo@gmail.com)
+ * @file        : pacer
+ * @created     : Saturday Oct 17, 2026 22:24:31 CEST
+ * @license     : MIT
+ */
+
+#include "pacer.hpp"
+
+#include <cmath>
+#include <thread>
+#include <numeric>
+#include <algorithm>
+
+#include <fmt/format.h>
+
+namespace brun
+{
+
+void frame_histogram::record(milliseconds const time) noexcept
+{
+    auto const bucket = static_cast<std::size_t>(std::max(time.count(), 0.) / bucket_width);
+    ++_counts[std::min(bucket, bucket_count)];
+    ++_frames;
+    _max = std::max(_max, time);
+}
+
+auto frame_histogram::percentile(double const p) const noexcept
+    -> milliseconds
+{
+    if (_frames == 0) {
+        return milliseconds{0.};
+    }
+    auto const rank = static_cast<std::uint64_t>(std::ceil(p * static_cast<double>(_frames)));
+    auto seen = std::uint64_t{0};
+    for (auto i = 0ul; i < bucket_count; ++i) {
+        seen += _counts[i];
+        if (seen >= std::max(rank, std::uint64_t{1})) {
+            return std::min(milliseconds{static_cast<double>(i + 1) * bucket_width}, _max);
+        }
+    }
+    return _max;
+}
+
+void frame_histogram::dump(std::FILE * const out) const
+{
+    fmt::print(out, "Frame times: {} frames, p50 {:.2f} ms, p99 {:.2f} ms, max {:.2f} ms\n",
+               _frames, percentile(0.5).count(), percentile(0.99).count(), _max.count());
+    constexpr auto per_ms = static_cast<std::size_t>(1. / bucket_width);
+    for (auto first = 0ul; first < bucket_count; first += per_ms) {
+        auto const count = std::accumulate(_counts.begin() + first, _counts.begin() + first + per_ms, std::uint64_t{0});
+        if (count > 0) {
+            fmt::print(out, "  {:>3} - {:>3} ms: {}\n", first / per_ms, first / per_ms + 1, count);
+        }
+    }
+    if (auto const count = _counts[bucket_count]; count > 0) {
+        fmt::print(out, "  over {} ms: {}\n", bucket_count / per_ms, count);
+    }
+}
+
+frame_pacer::frame_pacer(double const fps)
+    : _period{std::chrono::duration_cast<clock::duration>(std::chrono::duration<double>{1. / fps})},
+      _deadline{clock::now()}
+{
+}
+
+void frame_pacer::wait()
+{
+    // Sleeping may overshoot: the last part of the wait is spent yielding
+    constexpr auto spin = std::chrono::microseconds{500};
+    if (clock::now() < _deadline - spin) {
+        std::this_thread::sleep_until(_deadline - spin);
+    }
+    while (clock::now() < _deadline) {
+        std::this_thread::yield();
+    }
+
+    auto const now = clock::now();
+    if (_last_frame != clock::time_point{}) {
+        _histogram.record(now - _last_frame);
+    }
+    _last_frame = now;
+    _deadline += _period;
+    if (now >= _deadline) {
+        // More than a frame late: the frames lost are dropped, and the next one keeps the pace
+        auto const lost = (now - _deadline) / _period + 1;
+        _dropped += static_cast<std::uint64_t>(lost);
+        _deadline += lost * _period;
+    }
+}
+
+void frame_pacer::skip() noexcept
+{
+    _last_frame = clock::time_point{};
+    ++_skipped;
+}
+
+} // namespace brun
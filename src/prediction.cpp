@@ -0,0 +1,190 @@
+/**
+ * @author      : Riccardo Brugo (brugo.riccardo@gmail.com)
+ * @file        : prediction
+ * @created     : Sunday Oct 18, 2026 01:44:03 CEST
+ * @license     : MIT
+ */
+
+#include "prediction.hpp"
+#include "trail.hpp"
+
+#include <cmath>
+#include <mutex>
+#include <chrono>
+
+namespace brun
+{
+
+namespace
+{
+    // G, with masses in Yg and distances in Gm [Gm³/(Yg·s²)]
+    constexpr auto G = brun::constants::G<>.count() * 1e21 / 1e27;
+    constexpr auto seconds_per_day = 86400.;
+    // How often a predictor with nothing to do looks again
+    constexpr auto idle = std::chrono::milliseconds{50};
+
+    using vec3 = std::array<double, 3>;
+
+    // The copy of the state which is integrated: only the bodies which pull the others or which are
+    //  predicted are kept
+    struct state
+    {
+        std::vector<vec3> r;                // [Gm]
+        std::vector<vec3> v;                // [Gm/s]
+        std::vector<vec3> a;                // [Gm/s²]
+        std::vector<double> mass;           // [Yg]
+        std::vector<std::uint8_t> movable;  // the bodies without a velocity stay where they are
+        std::vector<std::size_t> massive;
+        std::vector<std::size_t> tracked;   // the predicted bodies
+
+        void clear() noexcept
+        {
+            r.clear();
+            v.clear();
+            mass.clear();
+            movable.clear();
+            massive.clear();
+            tracked.clear();
+        }
+
+        void accelerate() noexcept
+        {
+            a.assign(r.size(), vec3{});
+            for (auto i = 0ul; i < r.size(); ++i) {
+                if (movable[i] == 0) {
+                    continue;
+                }
+                auto & acc = a[i];
+                for (auto const j : massive) {
+                    if (j == i) {
+                        continue;
+                    }
+                    auto const d = vec3{r[j][0] - r[i][0], r[j][1] - r[i][1], r[j][2] - r[i][2]};
+                    auto const distance2 = d[0] * d[0] + d[1] * d[1] + d[2] * d[2];
+                    auto const k = G * mass[j] / (distance2 * std::sqrt(distance2));
+                    acc = {acc[0] + k * d[0], acc[1] + k * d[1], acc[2] + k * d[2]};
+                }
+            }
+        }
+
+        // Kick-drift-kick: a single evaluation of the field per step, against the two of the simulation
+        void leapfrog(double const dt) noexcept
+        {
+            auto const kick = [this](double const h) {
+                for (auto i = 0ul; i < v.size(); ++i) {
+                    v[i] = {v[i][0] + a[i][0] * h, v[i][1] + a[i][1] * h, v[i][2] + a[i][2] * h};
+                }
+            };
+            kick(dt * 0.5);
+            for (auto i = 0ul; i < r.size(); ++i) {
+                r[i] = {r[i][0] + v[i][0] * dt, r[i][1] + v[i][1] * dt, r[i][2] + v[i][2] * dt};
+            }
+            accelerate();
+            kick(dt * 0.5);
+        }
+    };
+} // namespace
+
+trajectory_predictor::trajectory_predictor(brun::context & ctx)
+    : _ctx{ctx}
+{
+    _worker = std::jthread{[this](std::stop_token const stop) { work(stop); }};
+}
+
+void trajectory_predictor::work(std::stop_token const & stop)
+{
+    auto copy = state{};
+    auto shown = false;     // whether the last prediction published has any body
+    while (not stop.stop_requested()) {
+        if (not enabled() or _ctx.status.load(std::memory_order::acquire) != brun::status::running) {
+            if (shown) {
+                _latest.back() = brun::trajectories{};
+                _latest.publish();
+                _published.fetch_add(1, std::memory_order::release);
+                shown = false;
+            }
+            std::this_thread::sleep_for(idle);
+            continue;
+        }
+
+        auto const horizon = this->horizon();
+        auto & out = _latest.back();
+        out.bodies.clear();
+        copy.clear();
+        auto revision = std::uint64_t{0};
+        auto start = 0.;
+        {
+            auto const lock = std::shared_lock{_ctx};
+            auto const & registry = _ctx.reg;
+            revision = _ctx.revision.load(std::memory_order::acquire);
+            start = _ctx.clock.load(std::memory_order::acquire);
+            registry.view<brun::position const, brun::mass const>().each(
+                [&](auto const entt, auto const & position, auto const mass) {
+                    auto const tracked = registry.has<brun::trail>(entt);
+                    if (mass.count() <= 0 and not tracked) {
+                        return;
+                    }
+                    auto const * velocity = registry.try_get<brun::velocity>(entt);
+                    auto const index = copy.r.size();
+                    if (mass.count() > 0) {
+                        copy.massive.push_back(index);
+                    }
+                    if (tracked) {
+                        copy.tracked.push_back(index);
+                        out.bodies.push_back(entt);
+                    }
+                    copy.r.push_back({position[0].count(), position[1].count(), position[2].count()});
+                    copy.v.push_back(velocity == nullptr ? vec3{} : vec3{
+                        (*velocity)[0].count() * 1e-6, (*velocity)[1].count() * 1e-6, (*velocity)[2].count() * 1e-6
+                    });
+                    copy.mass.push_back(mass.count());
+                    copy.movable.push_back(velocity != nullptr ? 1 : 0);
+                }
+            );
+        }
+
+        // The prediction is dropped as soon as it is of no use
+        auto const outdated = [&] {
+            return stop.stop_requested() or not enabled() or this->horizon() != horizon
+                or _ctx.revision.load(std::memory_order::acquire) != revision;
+        };
+        auto const record = [&out, &copy](std::size_t const sample) {
+            for (auto k = 0ul; k < copy.tracked.size(); ++k) {
+                auto const & r = copy.r[copy.tracked[k]];
+                out.points[k * samples + sample] = brun::position{
+                    brun::position_scalar{r[0]}, brun::position_scalar{r[1]}, brun::position_scalar{r[2]}
+                };
+            }
+        };
+        out.start = start;
+        out.horizon = horizon;
+        out.samples = samples;
+        out.points.resize(copy.tracked.size() * samples);
+        auto const interval = horizon / static_cast<double>(samples - 1);     // between two samples [days]
+        auto const dt = interval / substeps * seconds_per_day;
+        copy.accelerate();
+        record(0);
+        auto dropped = false;
+        for (auto sample = 1ul; sample < samples and not dropped; ++sample) {
+            for (auto step = 0; step < substeps; ++step) {
+                copy.leapfrog(dt);
+            }
+            record(sample);
+            dropped = outdated();
+        }
+        if (dropped) {
+            continue;
+        }
+        _latest.publish();
+        _published.fetch_add(1, std::memory_order::release);
+        shown = true;
+
+        // The next prediction starts when the simulation has gone past the first sample of this one
+        while (not outdated() and _ctx.status.load(std::memory_order::acquire) == brun::status::running
+               and _ctx.clock.load(std::memory_order::acquire) < start + interval) {
+            std::this_thread::sleep_for(idle);
+        }
+    }
+}
+
+} // namespace brun
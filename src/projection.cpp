@@ -0,0 +1,81 @@
+/**
+ * @author      : Riccardo Brugo (brugo.riccardo@gmail.com)
+ * @file        : projection
+ * @created     : Saturday Oct 17, 2026 18:35:02 CEST
+ * @license     : MIT
+ */
+
+#include "projection.hpp"
+
+#include <numeric>
+#include <algorithm>
+#include <execution>                 // for parallelism    (std::execution::par)
+
+namespace brun
+{
+
+namespace
+{
+    // Below this many points a thread costs more than it saves
+    constexpr auto chunk_size = std::size_t{16384};
+
+    void project_range(
+        brun::projection const & view, brun::position const * points,
+        float * __restrict x, float * __restrict y, float * __restrict distance2, std::size_t const n
+    ) noexcept
+    {
+        auto const & [r0, r1, r2] = view.m;
+        for (auto i = 0ul; i < n; ++i) {
+            auto const px = points[i][0].count(), py = points[i][1].count(), pz = points[i][2].count();
+            auto const u = r0[0] * px + r0[1] * py + r0[2] * pz + r0[3];
+            auto const v = r1[0] * px + r1[1] * py + r1[2] * pz + r1[3];
+            auto const w = r2[0] * px + r2[1] * py + r2[2] * pz + r2[3];
+            x[i] = static_cast<float>(u) + view.center_x;
+            y[i] = static_cast<float>(v) + view.center_y;
+            distance2[i] = static_cast<float>(u * u + v * v + w * w);
+        }
+    }
+} // namespace
+
+auto make_projection(
+    brun::position const & origin, brun::rotation_matrix const & rotation, double const px_per_Gm,
+    int const width, int const height
+)
+    -> brun::projection
+{
+    auto res = brun::projection{};
+    for (auto i = 0; i < 3; ++i) {
+        auto & row = res.m[static_cast<std::size_t>(i)];
+        row[3] = 0.;
+        for (auto j = 0; j < 3; ++j) {
+            row[static_cast<std::size_t>(j)] = px_per_Gm * rotation(i, j);
+            row[3] -= row[static_cast<std::size_t>(j)] * origin[j].count();
+        }
+    }
+    res.center_x = static_cast<float>(width / 2);
+    res.center_y = static_cast<float>(height / 2);
+    return res;
+}
+
+void project(brun::projection const & view, std::span<brun::position const> const points, brun::projected_points & out)
+{
+    auto const n = points.size();
+    out.x.resize(n);
+    out.y.resize(n);
+    out.distance2.resize(n);
+    if (n <= chunk_size) {
+        project_range(view, points.data(), out.x.data(), out.y.data(), out.distance2.data(), n);
+        return;
+    }
+    auto chunks = std::vector<std::size_t>((n + chunk_size - 1) / chunk_size);
+    std::iota(chunks.begin(), chunks.end(), 0ul);
+    std::for_each(std::execution::par, chunks.begin(), chunks.end(), [&](auto const chunk) {
+        auto const first = chunk * chunk_size;
+        project_range(
+            view, points.data() + first, out.x.data() + first, out.y.data() + first, out.distance2.data() + first,
+            std::min(chunk_size, n - first)
+        );
+    });
+}
+
+} // namespace brun
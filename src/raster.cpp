@@ -0,0 +1,242 @@
+/**
+ * @author      : Riccardo Brugo (brugo.riccardo@gmail.com)
+ * @file        : raster
+ * @created     : Saturday Oct 17, 2026 23:31:05 CEST
+ * @license     : MIT
+ */
+
+#include "raster.hpp"
+
+#include <cmath>
+#include <array>
+#include <algorithm>
+#include <execution>                 // for parallelism    (std::execution::par)
+
+namespace brun
+{
+
+namespace
+{
+    struct rgba { float r, g, b, a; };
+
+    auto unpack(std::uint32_t const c) noexcept
+    {
+        constexpr auto k = 1.f / 255.f;
+        return rgba{
+            static_cast<float>(c & 0xff) * k, static_cast<float>(c >> 8 & 0xff) * k,
+            static_cast<float>(c >> 16 & 0xff) * k, static_cast<float>(c >> 24) * k
+        };
+    }
+
+    // The same polynomial fit of "inferno" of the density shader
+    auto inferno(float const t) noexcept
+    {
+        constexpr auto c = std::array<std::array<float, 3>, 7>{{
+            {0.0002189403691192265f, 0.001651004631001012f, -0.01948089843709184f},
+            {0.1065134194856116f, 0.5639564367884091f, 3.932712388889277f},
+            {11.60249308247187f, -3.972853965665698f, -15.9423941062914f},
+            {-41.70399613139459f, 17.43639888205313f, 44.35414519872813f},
+            {77.162935699427f, -33.40235894210092f, -81.80730925738993f},
+            {-71.31942824499214f, 32.62606426397723f, 73.20951985803202f},
+            {25.13112622477341f, -12.24266895238567f, -23.07032500287172f},
+        }};
+        auto res = std::array<float, 3>{};
+        for (auto k = 0ul; k < 3; ++k) {
+            auto v = c[6][k];
+            for (auto i = 6; i-- > 0; ) {
+                v = c[static_cast<std::size_t>(i)][k] + t * v;
+            }
+            res[k] = v;
+        }
+        return res;
+    }
+
+    // The pixels of a tile: nothing is drawn outside of it
+    class canvas
+    {
+        std::vector<float> & _color;
+        int _width;
+        int _x0, _y0, _x1, _y1;
+
+    public:
+        canvas(std::vector<float> & color, int const width, int const x0, int const y0, int const x1, int const y1)
+            : _color{color}, _width{width}, _x0{x0}, _y0{y0}, _x1{x1}, _y1{y1}
+        {}
+
+        // Blends a color over pixel (x, y), with its alpha (glBlendFunc(GL_SRC_ALPHA, GL_ONE_MINUS_SRC_ALPHA))
+        void blend(int const x, int const y, rgba const c) noexcept
+        {
+            if (x < _x0 or y < _y0 or x >= _x1 or y >= _y1 or c.a <= 0.f) {
+                return;
+            }
+            auto * const p = _color.data() + (static_cast<std::size_t>(y) * static_cast<std::size_t>(_width)
+                                              + static_cast<std::size_t>(x)) * 3;
+            p[0] = c.r * c.a + p[0] * (1.f - c.a);
+            p[1] = c.g * c.a + p[1] * (1.f - c.a);
+            p[2] = c.b * c.a + p[2] * (1.f - c.a);
+        }
+
+        // A segment one pixel wide, with the colors interpolated; its last pixel is left to the next segment
+        // The steps are the ones of the whole segment, so that the tiles draw the same pixels as a single
+        //  canvas would; only the ones which may fall in the tile are walked
+        void line(brun::trail_vertex const & a, brun::trail_vertex const & b) noexcept
+        {
+            auto const dx = b.x - a.x, dy = b.y - a.y;
+            auto const steps = static_cast<int>(std::ceil(std::max(std::abs(dx), std::abs(dy))));
+            if (steps == 0) {
+                return;
+            }
+            // Liang-Barsky, on the tile grown by a pixel
+            auto t0 = 0.f, t1 = 1.f;
+            auto const clip = [&t0, &t1](float const p, float const q) {
+                if (p == 0.f) {
+                    return q >= 0.f;
+                }
+                auto const r = q / p;
+                if (p < 0.f) {
+                    t0 = std::max(t0, r);
+                } else {
+                    t1 = std::min(t1, r);
+                }
+                return t0 <= t1;
+            };
+            auto const inside = clip(-dx, a.x - static_cast<float>(_x0 - 1)) and clip(dx, static_cast<float>(_x1 + 1) - a.x)
+                            and clip(-dy, a.y - static_cast<float>(_y0 - 1)) and clip(dy, static_cast<float>(_y1 + 1) - a.y);
+            if (not inside) {
+                return;
+            }
+            auto const ca = unpack(a.color), cb = unpack(b.color);
+            auto const first = std::max(static_cast<int>(std::floor(t0 * static_cast<float>(steps))), 0);
+            auto const last  = std::min(static_cast<int>(std::ceil(t1 * static_cast<float>(steps))), steps - 1);
+            for (auto s = first; s <= last; ++s) {
+                auto const t = static_cast<float>(s) / static_cast<float>(steps);
+                blend(static_cast<int>(std::floor(a.x + t * dx)), static_cast<int>(std::floor(a.y + t * dy)), {
+                    std::lerp(ca.r, cb.r, t), std::lerp(ca.g, cb.g, t), std::lerp(ca.b, cb.b, t), std::lerp(ca.a, cb.a, t)
+                });
+            }
+        }
+
+        // A disc: every pixel is covered as far as its center is within half a pixel from the edge
+        void disc(brun::sprite const & s) noexcept
+        {
+            auto const c = unpack(s.color);
+            auto const reach = s.radius + 1.f;
+            auto const x0 = std::max(static_cast<int>(std::floor(s.x - reach)), _x0);
+            auto const x1 = std::min(static_cast<int>(std::ceil(s.x + reach)), _x1 - 1);
+            auto const y0 = std::max(static_cast<int>(std::floor(s.y - reach)), _y0);
+            auto const y1 = std::min(static_cast<int>(std::ceil(s.y + reach)), _y1 - 1);
+            for (auto y = y0; y <= y1; ++y) {
+                for (auto x = x0; x <= x1; ++x) {
+                    auto const d = std::hypot(static_cast<float>(x) + 0.5f - s.x, static_cast<float>(y) + 0.5f - s.y);
+                    auto const coverage = std::clamp(s.radius + 0.5f - d, 0.f, 1.f);
+                    blend(x, y, {c.r, c.g, c.b, c.a * coverage});
+                }
+            }
+        }
+    };
+
+    auto to_byte(float const v) noexcept
+    {
+        return static_cast<std::uint8_t>(std::lround(std::clamp(v, 0.f, 1.f) * 255.f));
+    }
+} // namespace
+
+void software_scene::bin(brun::frame_geometry const & geometry, int const width, int const height)
+{
+    _columns = (width + tile_size - 1) / tile_size;
+    _rows = (height + tile_size - 1) / tile_size;
+    _tiles.resize(static_cast<std::size_t>(_columns * _rows));
+    for (auto row = 0; row < _rows; ++row) {
+        for (auto column = 0; column < _columns; ++column) {
+            auto & t = _tiles[static_cast<std::size_t>(row * _columns + column)];
+            t.x0 = column * tile_size;
+            t.y0 = row * tile_size;
+            t.x1 = std::min(t.x0 + tile_size, width);
+            t.y1 = std::min(t.y0 + tile_size, height);
+            t.segments.clear();
+            t.sprites.clear();
+        }
+    }
+
+    // Calls `f(tile)` on the tiles which a box [px] touches
+    auto const for_each_tile = [this](float const x0, float const y0, float const x1, float const y1, auto && f) {
+        auto const first_column = std::max(static_cast<int>(std::floor(x0)) / tile_size, 0);
+        auto const last_column  = std::min(static_cast<int>(std::floor(x1)) / tile_size, _columns - 1);
+        auto const first_row = std::max(static_cast<int>(std::floor(y0)) / tile_size, 0);
+        auto const last_row  = std::min(static_cast<int>(std::floor(y1)) / tile_size, _rows - 1);
+        if (x1 < 0.f or y1 < 0.f) {
+            return;
+        }
+        for (auto row = first_row; row <= last_row; ++row) {
+            for (auto column = first_column; column <= last_column; ++column) {
+                f(_tiles[static_cast<std::size_t>(row * _columns + column)]);
+            }
+        }
+    };
+
+    for (auto i = 0ul; i < geometry.counts.size(); ++i) {
+        auto const first = static_cast<std::size_t>(geometry.firsts[i]);
+        auto const count = static_cast<std::size_t>(geometry.counts[i]);
+        for (auto k = first; k + 1 < first + count; ++k) {
+            auto const & a = geometry.vertices[k];
+            auto const & b = geometry.vertices[k + 1];
+            auto const index = static_cast<std::uint32_t>(k);
+            for_each_tile(std::min(a.x, b.x) - 1.f, std::min(a.y, b.y) - 1.f, std::max(a.x, b.x) + 1.f,
+                          std::max(a.y, b.y) + 1.f, [index](tile & t) { t.segments.push_back(index); });
+        }
+    }
+    for (auto i = 0ul; i < geometry.sprites.size(); ++i) {
+        auto const & s = geometry.sprites[i];
+        auto const reach = s.radius + 1.f;
+        auto const index = static_cast<std::uint32_t>(i);
+        for_each_tile(s.x - reach, s.y - reach, s.x + reach, s.y + reach, [index](tile & t) {
+            t.sprites.push_back(index);
+        });
+    }
+}
+
+void software_scene::draw(brun::frame_geometry const & geometry, int const width, int const height, brun::rgb_image & out)
+{
+    auto const pixels = static_cast<std::size_t>(width) * static_cast<std::size_t>(height);
+    _color.assign(pixels * 3, 0.f);
+    out.width = width;
+    out.height = height;
+    out.pixels.resize(pixels * 3);
+    bin(geometry, width, height);
+
+    auto const has_density = geometry.density.size() == pixels;
+    auto const scale = 1.f / std::log(1.f + std::max(geometry.density_peak, 1.f));
+    std::for_each(std::execution::par, _tiles.begin(), _tiles.end(), [&](tile const & t) {
+        auto target = canvas{_color, width, t.x0, t.y0, t.x1, t.y1};
+
+        // Motion trails first, then the test particles and the bodies over them
+        for (auto const k : t.segments) {
+            target.line(geometry.vertices[k], geometry.vertices[k + 1]);
+        }
+        if (has_density) {
+            for (auto y = t.y0; y < t.y1; ++y) {
+                for (auto x = t.x0; x < t.x1; ++x) {
+                    auto const count = geometry.density[static_cast<std::size_t>(y) * static_cast<std::size_t>(width)
+                                                        + static_cast<std::size_t>(x)];
+                    if (count > 0.f) {
+                        auto const v = std::log(1.f + count) * scale;
+                        auto const [r, g, b] = inferno(0.15f + 0.85f * v);
+                        target.blend(x, y, {r, g, b, std::clamp(0.35f + v, 0.f, 1.f)});
+                    }
+                }
+            }
+        }
+        for (auto const i : t.sprites) {
+            target.disc(geometry.sprites[i]);
+        }
+
+        for (auto y = t.y0; y < t.y1; ++y) {
+            auto const row = static_cast<std::size_t>(y) * static_cast<std::size_t>(width);
+            for (auto i = (row + static_cast<std::size_t>(t.x0)) * 3; i < (row + static_cast<std::size_t>(t.x1)) * 3; ++i) {
+                out.pixels[i] = to_byte(_color[i]);
+            }
+        }
+    });
+}
+
+} // namespace brun
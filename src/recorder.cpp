@@ -0,0 +1,206 @@
+/**
+ * @author      : Riccardo Brugo (brugo.riccardo@gmail.com)
+ * @file        : recorder
+ * @created     : Sunday Oct 18, 2026 00:12:47 CEST
+ * @license     : MIT
+ */
+
+#include "recorder.hpp"
+#include "gfx.hpp"
+#include "raster.hpp"
+#include "encoders.hpp"
+#include "geometry.hpp"
+
+#include <map>
+#include <atomic>
+#include <span>
+#include <deque>
+#include <mutex>
+#include <thread>
+#include <chrono>
+#include <fstream>
+#include <functional>
+#include <filesystem>
+#include <condition_variable>
+
+#include <fmt/format.h>
+
+namespace brun
+{
+
+namespace
+{
+    // Encodes the frames on a pool of threads, and hands them to `write` in order, one at a time
+    // At most `capacity` frames wait for a thread: the renderer waits when it gets that far ahead
+    class encoder_pool
+    {
+    public:
+        using encoder = std::function<std::vector<std::uint8_t>(brun::rgb_image const &)>;
+        using writer  = std::function<void(std::uint64_t, std::span<std::uint8_t const>)>;
+
+    private:
+        encoder _encode;
+        writer _write;
+        std::size_t _capacity;
+        std::mutex _mtx;
+        std::condition_variable _work;
+        std::condition_variable _room;
+        std::deque<std::pair<std::uint64_t, brun::rgb_image>> _queue;
+        std::uint64_t _pushed = 0;
+        bool _closing = false;
+        std::mutex _write_mtx;
+        std::map<std::uint64_t, std::vector<std::uint8_t>> _encoded;    // waiting for the frames before them
+        std::uint64_t _next = 0;                                        // the next frame to write
+        std::vector<std::jthread> _workers;
+
+        void work()
+        {
+            while (true) {
+                auto job = std::pair<std::uint64_t, brun::rgb_image>{};
+                {
+                    auto lock = std::unique_lock{_mtx};
+                    _work.wait(lock, [this] { return _closing or not _queue.empty(); });
+                    if (_queue.empty()) {
+                        return;
+                    }
+                    job = std::move(_queue.front());
+                    _queue.pop_front();
+                }
+                _room.notify_one();
+                auto bytes = _encode(job.second);
+                auto const _ = std::lock_guard{_write_mtx};
+                _encoded.emplace(job.first, std::move(bytes));
+                for (auto it = _encoded.begin(); it != _encoded.end() and it->first == _next; ++_next) {
+                    _write(it->first, it->second);
+                    it = _encoded.erase(it);
+                }
+            }
+        }
+
+    public:
+        encoder_pool(encoder encode, writer write, std::size_t const threads)
+            : _encode{std::move(encode)}, _write{std::move(write)}, _capacity{2 * threads}
+        {
+            for (auto i = 0ul; i < threads; ++i) {
+                _workers.emplace_back([this] { work(); });
+            }
+        }
+
+        // The frames left are encoded and written before the threads end
+        ~encoder_pool()
+        {
+            {
+                auto const _ = std::lock_guard{_mtx};
+                _closing = true;
+            }
+            _work.notify_all();
+            _workers.clear();
+        }
+
+        void push(brun::rgb_image image)
+        {
+            auto lock = std::unique_lock{_mtx};
+            _room.wait(lock, [this] { return _queue.size() < _capacity; });
+            _queue.emplace_back(_pushed++, std::move(image));
+            lock.unlock();
+            _work.notify_one();
+        }
+    };
+
+    // The name of the PNG file of a frame: a path without a placeholder gets one before its extension
+    auto png_pattern(std::filesystem::path const & path)
+        -> std::string
+    {
+        auto const name = path.string();
+        if (name.find('{') != std::string::npos) {
+            return name;
+        }
+        auto stem = path;
+        stem.replace_extension();
+        return fmt::format("{}_{{:05}}{}", stem.string(), path.extension().string());
+    }
+} // namespace
+
+void record_cycle(brun::context & ctx, simulation_params const & params) noexcept
+{
+    auto const & record = params.record;
+    auto const & path = record.path;
+    auto const fps = static_cast<int>(params.fps.count());
+    // The video shows `days_per_second` simulated days every second
+    auto const days_per_frame = params.days_per_second.count() / params.fps.count();
+    auto const is_video = std::filesystem::path{path}.extension() == ".y4m";
+    auto const pattern = png_pattern(path);
+
+    auto video = std::ofstream{};
+    auto failed = std::atomic<bool>{false};
+    auto encode = encoder_pool::encoder{};
+    auto write  = encoder_pool::writer{};
+    if (is_video) {
+        video.open(path, std::ios::binary);
+        video << brun::y4m_header(record.width, record.height, fps);
+        encode = [](auto const & image) { return brun::encode_y4m_frame(image); };
+        write = [&](std::uint64_t, std::span<std::uint8_t const> const bytes) {
+            video.write(reinterpret_cast<char const *>(bytes.data()), static_cast<std::streamsize>(bytes.size()));
+            if (not video and not failed.exchange(true)) {
+                fmt::print(stderr, "Error - can't write the video \"{}\"\n", path);
+            }
+        };
+    } else {
+        try {
+            [[maybe_unused]] auto const first = fmt::format(pattern, 0);
+        } catch (fmt::format_error const & e) {
+            fmt::print(stderr, "Error - \"{}\" is not a pattern for the names of the frames: {}\n", path, e.what());
+            failed = true;
+        }
+        encode = [](auto const & image) { return brun::encode_png(image); };
+        write = [&](std::uint64_t const index, std::span<std::uint8_t const> const bytes) {
+            auto const name = fmt::format(pattern, index);
+            auto file = std::ofstream{name, std::ios::binary};
+            file.write(reinterpret_cast<char const *>(bytes.data()), static_cast<std::streamsize>(bytes.size()));
+            if (not file and not failed.exchange(true)) {
+                fmt::print(stderr, "Error - can't write the frame \"{}\"\n", name);
+            }
+        };
+    }
+    if (is_video and not video) {
+        fmt::print(stderr, "Error - can't open the video \"{}\"\n", path);
+        failed = true;
+    }
+
+    // Wait for the simulation
+    while (ctx.status.load(std::memory_order::acquire) == brun::status::starting) {
+        std::this_thread::yield();
+    }
+
+    auto late = std::uint64_t{0};
+    auto recorded = std::uint64_t{0};
+    {
+        auto const threads = std::max(std::thread::hardware_concurrency(), 2u) - 1;
+        auto pool = encoder_pool{encode, write, threads};
+        auto scene = brun::software_scene{};
+        auto geometry = brun::frame_geometry{};
+        auto next = ctx.clock.load(std::memory_order::acquire);
+        while (not failed and (record.frames == 0 or recorded < record.frames)) {
+            // Every frame shows the first state at its time, or after it when the renderer falls behind
+            auto now = ctx.clock.load(std::memory_order::acquire);
+            while (now < next and ctx.status.load(std::memory_order::acquire) == brun::status::running) {
+                std::this_thread::sleep_for(std::chrono::microseconds{200});
+                now = ctx.clock.load(std::memory_order::acquire);
+            }
+            if (ctx.status.load(std::memory_order::acquire) != brun::status::running) {
+                break;
+            }
+            late += now >= next + days_per_frame ? 1 : 0;
+            auto image = brun::rgb_image{};
+            brun::build_geometry(ctx, record.width, record.height, record.density, geometry);
+            scene.draw(geometry, record.width, record.height, image);
+            pool.push(std::move(image));
+            ++recorded;
+            next += days_per_frame;
+        }
+    }
+    ctx.status.store(brun::status::stopped, std::memory_order::release);
+    fmt::print("Recorded {} frames to \"{}\" ({} taken more than a frame late)\n", recorded, path, late);
+}
+
+} // namespace brun
@@ -0,0 +1,183 @@
+/**
+ * @author      : Riccardo Brugo (brugo.riccardo@gmail.com)
+ * @file        : reload
+ * @created     : Saturday Oct 17, 2026 15:24:09 CEST
+ * @license     : MIT
+ */
+
+#include "reload.hpp"
+#include "config.hpp"
+#include "trail.hpp"
+#include "orbits.hpp"
+#include "names.hpp"
+
+#include <mutex>
+#include <vector>
+#include <optional>
+#include <exception>
+#include <string_view>
+#include <unordered_map>
+#include <unordered_set>
+
+#include <fmt/format.h>
+#include <fmt/ostream.h>
+
+namespace brun
+{
+
+namespace
+{
+    auto same_color(SDLpp::color const & lhs, SDLpp::color const & rhs) noexcept
+    {
+        auto const [r0, g0, b0, a0] = lhs;
+        auto const [r1, g1, b1, a1] = rhs;
+        return r0 == r1 and g0 == g1 and b0 == b1 and a0 == a1;
+    }
+
+    // The bodies of the registry, as they would be read from the scenario (apart from their state)
+    auto snapshot(brun::context const & ctx)
+        -> std::vector<brun::body_record>
+    {
+        auto const lock = std::shared_lock{ctx};
+        auto const & registry = ctx.reg;
+        auto res = std::vector<brun::body_record>{};
+        registry.view<brun::tag const, brun::mass const, SDLpp::color const, brun::px_radius const>().each(
+            [&](auto const entt, auto const & name, auto const mass, auto const & color, auto const px_radius) {
+                auto const * trail = registry.try_get<brun::trail>(entt);
+                auto const * parked = registry.try_get<brun::parked_trail>(entt);
+                auto const trail_size = parked != nullptr ? static_cast<int32_t>(parked->length)
+                                      : trail != nullptr  ? static_cast<int32_t>(trail->length())
+                                      : 0;
+                res.push_back(brun::body_record{std::string{name.view()}, mass, {}, {}, color, px_radius, trail_size});
+            }
+        );
+        return res;
+    }
+} // namespace
+
+auto diff_bodies(std::span<brun::body_record const> before, std::span<brun::body_record const> after)
+    -> scenario_diff
+{
+    auto old_bodies = std::unordered_map<std::string_view, brun::body_record const *>{};
+    for (auto const & body : before) {
+        old_bodies.insert_or_assign(body.name, &body);
+    }
+    auto new_names = std::unordered_set<std::string_view>{};
+
+    auto res = scenario_diff{};
+    for (auto const & body : after) {
+        new_names.insert(body.name);
+        auto const found = old_bodies.find(body.name);
+        if (found == old_bodies.end()) {
+            res.added.push_back(body);
+            continue;
+        }
+        auto const & old = *found->second;
+        if (old.mass != body.mass or not same_color(old.color, body.color)
+            or old.px_radius != body.px_radius or old.trail_size != body.trail_size) {
+            res.changed.push_back(body);
+        }
+    }
+    for (auto const & body : before) {
+        if (not new_names.contains(body.name)) {
+            res.removed.push_back(body.name);
+        }
+    }
+    return res;
+}
+
+void apply_diff(brun::context & ctx, scenario_diff diff)
+{
+    auto & registry = ctx.reg;
+    auto entities = std::unordered_map<std::string_view, entt::entity>{};
+    registry.view<brun::tag const>().each([&entities](auto const entt, auto const & name) {
+        entities.insert_or_assign(name, entt);
+    });
+
+    for (auto const & body : diff.changed) {
+        auto const found = entities.find(body.name);
+        if (found == entities.end()) {
+            continue;
+        }
+        auto const entt = found->second;
+        registry.get<brun::mass>(entt)      = body.mass;
+        registry.get<SDLpp::color>(entt)    = body.color;
+        registry.get<brun::px_radius>(entt) = body.px_radius;
+        if (body.trail_size > 0) {
+            // The trail is cut or extended on the oldest side
+            auto const length = static_cast<std::size_t>(body.trail_size);
+            // A trail drawn as an orbit gets its length when it is drawn again
+            if (auto * parked = registry.try_get<brun::parked_trail>(entt); parked != nullptr) {
+                parked->length = length;
+            } else if (auto * tail = registry.try_get<brun::trail>(entt); tail != nullptr) {
+                tail->resize(length);
+            } else {
+                registry.emplace<brun::trail>(entt, length, registry.get<brun::position>(entt), brun::trail_policy(registry));
+            }
+        } else {
+            registry.remove_if_exists<brun::trail, brun::parked_trail>(entt);
+        }
+    }
+
+    // Entities are destroyed only after all the names are found, because destroying one moves the components
+    //  of the others (and the names seen by `entities`)
+    auto removed = std::vector<entt::entity>{};
+    for (auto const & name : diff.removed) {
+        if (auto const found = entities.find(name); found != entities.end()) {
+            removed.push_back(found->second);
+        }
+    }
+    if (auto * index = registry.try_ctx<brun::name_index>(); index != nullptr) {
+        index->remove(removed);
+    }
+    for (auto const entt : removed) {
+        // The camera can't keep following an object which does not exist anymore
+        auto const * followed = std::get_if<brun::follow::target>(&ctx.follow);
+        if (followed != nullptr and followed->id == entt) {
+            ctx.follow = brun::follow::com{followed->offset};
+            ctx.camera_moved();
+        }
+        registry.destroy(entt);
+    }
+
+    fmt::print("Scenario reloaded: {} objects added, {} removed, {} changed\n",
+               diff.added.size(), diff.removed.size(), diff.changed.size());
+    brun::insert_bodies(registry, std::move(diff.added));
+}
+
+scenario_reloader::scenario_reloader(brun::context & ctx, std::vector<std::filesystem::path> files)
+    : _ctx{ctx},
+      _files{std::move(files)},
+      _bodies{snapshot(ctx)},
+      _watcher{_files, [this](auto const &) { reload(); }}
+{
+}
+
+void scenario_reloader::reload()
+{
+    auto read = std::optional<std::vector<brun::body_record>>{};
+    auto files = std::vector<std::filesystem::path>{};
+    try {
+        read = brun::read_bodies(_files.front(), &files);
+    } catch (std::exception const & ex) {
+        fmt::print(stderr, "Warning - can't reload {}: {}\n", _files.front(), ex.what());
+        return;
+    }
+    if (not read.has_value()) {
+        fmt::print(stderr, "Warning - can't reload {}: the running scenario is kept\n", _files.front());
+        return;
+    }
+    auto bodies = std::move(*read);
+    if (files != _files) {
+        fmt::print(stderr, "Warning - the list of included files has changed: "
+                           "restart to watch the new ones\n");
+    }
+
+    auto diff = diff_bodies(_bodies, bodies);
+    _bodies = std::move(bodies);
+    if (not diff.empty()) {
+        _ctx.defer([diff = std::move(diff)](brun::context & ctx) mutable { apply_diff(ctx, std::move(diff)); });
+    }
+}
+
+} // namespace brun
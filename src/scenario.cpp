@@ -0,0 +1,68 @@
+/**
+ * @author      : Riccardo Brugo (brugo.riccardo@gmail.com)
+ * @file        : scenario
+ * @created     : Saturday Oct 17, 2026 10:14:02 CEST
+ * @license     : MIT
+ */
+
+#include "scenario.hpp"
+#include "trail.hpp"
+#include "names.hpp"
+
+#include <span>
+#include <iterator>
+#include <algorithm>
+
+namespace brun
+{
+
+namespace
+{
+    // Collects a component from every record and inserts them all at once in the registry
+    template <typename Component, typename Projection>
+    void insert_component(
+        entt::registry & registry, std::span<entt::entity const> entities,
+        std::span<body_record> bodies, Projection && projection
+    )
+    {
+        auto values = std::vector<Component>{};
+        values.reserve(bodies.size());
+        std::ranges::transform(bodies, std::back_inserter(values), projection);
+        registry.insert<Component>(entities.begin(), entities.end(), values.begin(), values.end());
+    }
+} // namespace
+
+void insert_bodies(entt::registry & registry, std::vector<body_record> bodies)
+{
+    // Big catalogs are inserted at once: make room for all of them before creating anything
+    auto const count = bodies.size();
+    registry.reserve(registry.size() + count);
+    registry.reserve<brun::tag>(registry.size<brun::tag>() + count);
+    registry.reserve<brun::position>(registry.size<brun::position>() + count);
+    registry.reserve<brun::velocity>(registry.size<brun::velocity>() + count);
+    registry.reserve<brun::mass>(registry.size<brun::mass>() + count);
+    registry.reserve<SDLpp::color>(registry.size<SDLpp::color>() + count);
+    registry.reserve<brun::px_radius>(registry.size<brun::px_radius>() + count);
+
+    auto entities = std::vector<entt::entity>(count);
+    registry.create(entities.begin(), entities.end());
+
+    insert_component<brun::tag>      (registry, entities, bodies, [](auto & b) { return brun::tag{b.name}; });
+    insert_component<brun::position> (registry, entities, bodies, &body_record::position);
+    insert_component<brun::velocity> (registry, entities, bodies, &body_record::velocity);
+    insert_component<brun::mass>     (registry, entities, bodies, &body_record::mass);
+    insert_component<SDLpp::color>   (registry, entities, bodies, &body_record::color);
+    insert_component<brun::px_radius>(registry, entities, bodies, &body_record::px_radius);
+    registry.ctx_or_set<brun::name_index>().add(registry, entities);
+
+    // Only a few objects have a motion trail, and every trail has its own size
+    auto const policy = brun::trail_policy(registry);
+    for (auto i = 0ul; i < bodies.size(); ++i) {
+        if (auto const size = bodies[i].trail_size; size > 0) {
+            registry.emplace<brun::trail>(entities[i], static_cast<std::size_t>(size), bodies[i].position, policy);
+        }
+    }
+}
+
+} // namespace brun
+
@@ -5,9 +5,11 @@
  * @license     : MIT
  */
 
+#include <span>
 #include <mutex>
 #include <thread>
 #include <vector>
+#include <limits>
 #include <algorithm>                 // std::for_each, std::views::iota
 #include <execution>                 // for parallelism    (std::execution::par_unseq)
 
@@ -16,6 +18,8 @@
 
 #include "context.hpp"
 #include "simulation.hpp"
+#include "trail.hpp"
+#include "interpolation.hpp"
 
 namespace brun
 {
@@ -28,7 +32,11 @@ using brun::literals::operator""_kmps;
 using brun::literals::operator""_Yg;
 
 // Compute a step of simulation with a time interval of `dt` (default: 1 day)
-void update(brun::context & ctx, units::physical::si::time<units::physical::si::day> const dt = 1._q_d)
+// The trails take a sample at every fraction of the step in `samples`, interpolated along the step
+void update(
+    brun::context & ctx, units::physical::si::time<units::physical::si::day> const dt = 1._q_d,
+    std::span<double const> const samples = {}
+)
 {
     auto & reg = ctx.reg;
     //A list of objects which are movable
@@ -87,13 +95,38 @@ void update(brun::context & ctx, units::physical::si::time<units::physical::si::
         updated.push_back({target, r_fin, v_fin});
     });
     auto lock = std::scoped_lock{ctx};  // Lock the registry so I can write in it safely (bc multithread)
+    // How far the bodies went in the step, and how fast they go now: the renderer culls with them
+    auto farthest = 0.;
+    auto top_speed = 0.;
     for (auto const & [target, position, velocity] : updated) {
+        auto const & start = reg.get<brun::position>(target);
+        farthest  = std::max(farthest, brun::norm(position - start).count());
+        top_speed = std::max(top_speed, brun::norm(velocity).count() * 86400. / 1e6);
+        if (auto * const trail = samples.empty() ? nullptr : reg.try_get<brun::trail>(target); trail != nullptr) {
+            for (auto const fraction : samples) {
+                trail->push(start + fraction * (position - start));
+            }
+        }
+        // The renderer draws the bodies between the previous state and this one
+        reg.emplace_or_replace<brun::last_position>(target, start);
         reg.emplace_or_replace<brun::position>(target, position);
         reg.emplace_or_replace<brun::velocity>(target, velocity);
     }
+    auto const now = std::chrono::steady_clock::now();
+    auto & published = ctx.published;
+    published.interval = published.time != std::chrono::steady_clock::time_point{} ? now - published.time
+                                                                                    : std::chrono::steady_clock::duration{};
+    published.time = now;
+    published.days = dt.count();
+    ctx.travel.store(ctx.travel.load(std::memory_order::relaxed) + farthest, std::memory_order::release);
+    ctx.top_speed.store(top_speed, std::memory_order::release);
+    ctx.state_epoch.fetch_add(1, std::memory_order::release);
 }
 
-void simulation(brun::context & ctx, units::physical::si::time<units::physical::si::day> const days_per_second)
+void simulation(
+    brun::context & ctx, units::physical::si::time<units::physical::si::day> const days_per_second,
+    float const points_per_day
+)
 {
     auto & registry = ctx.reg;
     // Some config params - some will be configurable from the config file in the future
@@ -127,7 +160,23 @@ void simulation(brun::context & ctx, units::physical::si::time<units::physical::
     fmt::print(stderr, "timestep: {}\n", timestep);         // dτ
     fmt::print(stderr, "n_steps: {}\n", n_steps);           // n + 1
 
-    ctx.status.store(brun::status::running, std::memory_order::release);
+    // The trails take `points_per_day` samples each simulated day, at exact times: a sample which falls
+    //  inside a step is interpolated. Times are in minutes
+    auto const step_length = static_cast<double>(static_cast<decltype(dt)>(timestep).count());
+    auto const sample_period = points_per_day > 0
+                             ? static_cast<double>(static_cast<decltype(dt)>(1._q_d).count()) / points_per_day
+                             : std::numeric_limits<double>::infinity();
+    auto to_sample = sample_period;     // time left before the next sample
+    auto const step_days = static_cast<double>(
+        static_cast<units::physical::si::time<units::physical::si::day>>(timestep).count()
+    );
+    auto samples = std::vector<double>{};
+
+    // The program may have been stopped while it was starting
+    if (auto starting = brun::status::starting;
+        not ctx.status.compare_exchange_strong(starting, brun::status::running, std::memory_order::acq_rel)) {
+        return;
+    }
     for (auto const day : std::views::iota(first_day, last_day)) {
         accumulator -= 24._q_h;
         brun::dump(registry, day);  // Once a day, dumps data on terminal
@@ -138,7 +187,14 @@ void simulation(brun::context & ctx, units::physical::si::time<units::physical::
             }
             for ([[maybe_unused]] auto _ : std::views::iota(0, n_steps)) {
                 auto const begin = std::chrono::steady_clock::now();
-                update(ctx, timestep);
+                samples.clear();
+                for (; to_sample <= step_length; to_sample += sample_period) {
+                    samples.push_back(to_sample / step_length);
+                }
+                to_sample -= step_length;
+                update(ctx, timestep, samples);
+                ctx.clock.store(ctx.clock.load(std::memory_order::relaxed) + step_days, std::memory_order::release);
+                ctx.apply_edits();
                 accumulator = accumulator + timestep;
                 // Sign, `sleep` is not precise enough
                 std::this_thread::sleep_until(begin + std::chrono::microseconds{990} / (n_steps));
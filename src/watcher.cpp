@@ -0,0 +1,107 @@
+/**
+ * @author      : Riccardo Brugo (brugo.riccardo@gmail.com)
+ * @file        : watcher
+ * @created     : Saturday Oct 17, 2026 15:05:12 CEST
+ * @license     : MIT
+ */
+
+#include "watcher.hpp"
+
+#include <map>
+#include <set>
+#include <array>
+#include <algorithm>
+
+#include <poll.h>                    // poll
+#include <unistd.h>                  // read, close
+#include <sys/inotify.h>             // inotify_init1, inotify_add_watch
+
+#include <fmt/format.h>
+#include <fmt/ostream.h>
+
+namespace brun
+{
+
+namespace
+{
+    constexpr auto poll_timeout   = 200;   // ms, how often the stop token is checked
+    constexpr auto settle_timeout = 50;    // ms, how long a burst of events may last
+
+    auto normalize(std::filesystem::path const & path)
+        -> std::filesystem::path
+    {
+        auto error = std::error_code{};
+        auto res = std::filesystem::weakly_canonical(std::filesystem::absolute(path), error);
+        return error ? path : res;
+    }
+} // namespace
+
+file_watcher::file_watcher(std::vector<std::filesystem::path> files, callback on_change, trigger const when)
+    : _files{std::move(files)}, _on_change{std::move(on_change)}, _when{when}
+{
+    std::ranges::transform(_files, _files.begin(), normalize);
+    _thread = std::jthread{[this](std::stop_token const stop) { run(stop); }};
+}
+
+void file_watcher::run(std::stop_token const & stop) const
+{
+    auto const fd = ::inotify_init1(IN_NONBLOCK | IN_CLOEXEC);
+    if (fd < 0) {
+        fmt::print(stderr, "Warning - can't init inotify, the files will not be watched\n");
+        return;
+    }
+
+    auto const mask = IN_CLOSE_WRITE | IN_MOVED_TO | (_when == trigger::modified ? IN_MODIFY : 0u);
+    auto directories = std::map<int, std::filesystem::path>{};
+    for (auto const & file : _files) {
+        auto const directory = file.parent_path();
+        auto const wd = ::inotify_add_watch(fd, directory.c_str(), mask);
+        if (wd < 0) {
+            fmt::print(stderr, "Warning - can't watch {}\n", directory);
+            continue;
+        }
+        directories.emplace(wd, directory);
+    }
+
+    alignas(inotify_event) auto buffer = std::array<char, 4096>{};
+    auto changed = std::set<std::filesystem::path>{};
+    auto timeout = poll_timeout;
+    while (not stop.stop_requested()) {
+        auto pending = pollfd{fd, POLLIN, 0};
+        if (::poll(&pending, 1, timeout) <= 0) {
+            // Nothing more in the last burst: the files can be read
+            for (auto const & path : changed) {
+                _on_change(path);
+            }
+            changed.clear();
+            timeout = poll_timeout;
+            continue;
+        }
+
+        for (auto size = ::read(fd, buffer.data(), buffer.size()); size > 0;
+                  size = ::read(fd, buffer.data(), buffer.size())) {
+            for (auto offset = 0l; offset < size; ) {
+                auto const * event = reinterpret_cast<inotify_event const *>(buffer.data() + offset);
+                offset += static_cast<long>(sizeof(inotify_event) + event->len);
+                if (event->len == 0 or not directories.contains(event->wd)) {
+                    continue;
+                }
+                auto const path = directories.at(event->wd) / event->name;
+                if (std::ranges::find(_files, path) != _files.end()) {
+                    changed.insert(path);
+                }
+            }
+        }
+        // Appended files are read right away: a steady writer would never let them settle
+        if (_when == trigger::modified) {
+            for (auto const & path : changed) {
+                _on_change(path);
+            }
+            changed.clear();
+        }
+        timeout = changed.empty() ? poll_timeout : settle_timeout;
+    }
+    ::close(fd);
+}
+
+} // namespace brun